@@ -68,9 +68,18 @@
 #define configUSE_APPLICATION_TASK_TAG          0
 
 /* Memory allocation related definitions. */
-#define configSUPPORT_STATIC_ALLOCATION         0
+/* Application tasks and kernel objects in static memory, see static_alloc.h */
+#ifndef APP_STATIC_ALLOCATION
+#define APP_STATIC_ALLOCATION                   1
+#endif
+#define configSUPPORT_STATIC_ALLOCATION         APP_STATIC_ALLOCATION
 #define configSUPPORT_DYNAMIC_ALLOCATION        1
+#if APP_STATIC_ALLOCATION
+/* Heap is needed only for objects created at run time */
+#define configTOTAL_HEAP_SIZE                   ((size_t)(1024))
+#else
 #define configTOTAL_HEAP_SIZE                   ((size_t)(10240))
+#endif
 #define configAPPLICATION_ALLOCATED_HEAP        0
 
 /* Hook function related definitions. */
@@ -81,9 +90,12 @@
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
 
 /* Run time and task stats gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS           0
+#define configGENERATE_RUN_TIME_STATS           1
 #define configUSE_TRACE_FACILITY                1
 #define configUSE_STATS_FORMATTING_FUNCTIONS    0
+/* Run time counter is DWT cycle counter: DEMCR.TRCENA, DWT_CTRL.CYCCNTENA, DWT_CYCCNT, see cpu_load.h */
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() { ( *( volatile uint32_t * ) 0xE000EDFC ) |= ( 1UL << 24 ); ( *( volatile uint32_t * ) 0xE0001000 ) |= 1UL; }
+#define portGET_RUN_TIME_COUNTER_VALUE()        ( *( volatile uint32_t * ) 0xE0001004 )
 
 /* Co-routine related definitions. */
 #define configUSE_CO_ROUTINES                   0
@@ -108,7 +120,7 @@
 #define INCLUDE_xTaskGetSchedulerState          1
 #define INCLUDE_xTaskGetCurrentTaskHandle       1
 #define INCLUDE_uxTaskGetStackHighWaterMark     0
-#define INCLUDE_xTaskGetIdleTaskHandle          0
+#define INCLUDE_xTaskGetIdleTaskHandle          1
 #define INCLUDE_eTaskGetState                   0
 #define INCLUDE_xTimerPendFunctionCall          0
 #define INCLUDE_xTaskAbortDelay                 0
@@ -0,0 +1,64 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         CPU load from run time statistics of idle task
+//
+// **************************************************************************
+//
+// FreeRTOS kernel includes.
+#include "FreeRTOS.h"
+#include "task.h"
+
+// System includes.
+#include "board.h"
+#include "fsl_debug_console.h"
+#include "cpu_load.h"
+#include "static_alloc.h"
+
+#define TASK_NAME_CPU_LOAD		"cpu_load"
+
+static uint32_t g_load_period_ms;
+
+// Print load in 0.1 % from idle time of last period
+void task_cpu_load( void *t_arg )
+{
+	TickType_t l_wake = xTaskGetTickCount();
+	uint32_t l_last_total = portGET_RUN_TIME_COUNTER_VALUE();
+	uint32_t l_last_idle = ulTaskGetIdleRunTimeCounter();
+
+	while ( 1 )
+	{
+		vTaskDelayUntil( &l_wake, pdMS_TO_TICKS( g_load_period_ms ) );
+
+		uint32_t l_total = portGET_RUN_TIME_COUNTER_VALUE();
+		uint32_t l_idle = ulTaskGetIdleRunTimeCounter();
+
+		// skip period with overflow of counter
+		if ( l_total > l_last_total )
+		{
+			uint32_t l_idle_pm = ( uint64_t ) ( l_idle - l_last_idle ) * 1000 / ( l_total - l_last_total );
+			uint32_t l_load_pm = l_idle_pm < 1000 ? 1000 - l_idle_pm : 0;
+
+			PRINTF( "CPU load %u.%u %%\r\n", l_load_pm / 10, l_load_pm % 10 );
+		}
+
+		l_last_total = l_total;
+		l_last_idle = l_idle;
+	}
+}
+
+// Create task printing CPU load
+void CpuLoadInit( uint32_t t_period_ms, UBaseType_t t_priority )
+{
+	g_load_period_ms = t_period_ms;
+
+	if ( APP_TASK_CREATE( task_cpu_load, TASK_NAME_CPU_LOAD, configMINIMAL_STACK_SIZE + 100, NULL, t_priority, NULL ) != pdPASS )
+	{
+		PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_CPU_LOAD );
+	}
+}
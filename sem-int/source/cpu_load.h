@@ -0,0 +1,35 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         CPU load from run time statistics of idle task
+//
+// **************************************************************************
+//
+// Run time counter of FreeRTOS is DWT cycle counter (see FreeRTOSConfig.h).
+// Load task prints every period share of CPU cycles not spent in idle task.
+//
+// Cycle counter overflows every 2^32 cycles (36 s at 120 MHz) and kernel
+// loses time slice of task running over overflow, so period with overflow
+// is not printed. Period must be shorter than overflow.
+
+#ifndef CPU_LOAD_H
+#define CPU_LOAD_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define CPU_LOAD_PERIOD_MS		5000
+
+#if configGENERATE_RUN_TIME_STATS != 1 || INCLUDE_xTaskGetIdleTaskHandle != 1
+#error CPU load requires configGENERATE_RUN_TIME_STATS and INCLUDE_xTaskGetIdleTaskHandle
+#endif
+
+// Create task printing CPU load every t_period_ms
+void CpuLoadInit( uint32_t t_period_ms, UBaseType_t t_priority );
+
+#endif // CPU_LOAD_H
@@ -13,7 +13,7 @@
 //
 // FreeRTOS kernel includes.
 #include "FreeRTOS.h"
-#include "semphr.h"
+#include "task.h"
 
 // System includes.
 #include <stdio.h>
@@ -24,7 +24,18 @@
 //#include "MK64F12.h"
 //#include "fsl_debug_console.h"
 #include "gpio_interrupts.h"
+#include "spsc_ring.h"
 
+// All switches are on PORTC
+#define GPIO_IRQ_PORT			SW_PTC9_PORT
+#define GPIO_IRQ_GPIO			SW_PTC9_GPIO
+#define GPIO_IRQ_IRQn			PORTC_IRQn
+
+static GpioIrqCallback g_irq_callback[ GPIO_IRQ_PINS ];
+
+static SpscRing< EdgeEvent, GPIO_EDGE_RING_SIZE > g_edge_ring;
+static uint32_t g_edge_mask = 0;
+static TaskHandle_t g_edge_task = NULL;
 
 extern "C" {
 void PORTC_IRQHandler(void);
@@ -35,63 +46,87 @@ void PORTC_IRQHandler(void)
 {
 	// DO NOT USE return in this Interrupt Service Routine!!!
 
+	uint32_t l_cycles = DWT->CYCCNT;
+
     // Get mask of all current interrupts
-	uint32_t l_mask = GPIO_PortGetInterruptFlags( SW_PTC9_GPIO );
+	uint32_t l_mask = GPIO_PortGetInterruptFlags( GPIO_IRQ_GPIO );
+	uint32_t l_level = GPIO_IRQ_GPIO->PDIR;
+	BaseType_t l_woken = pdFALSE;
+	bool l_pushed = false;
 
-	TickType_t l_cur_tick = xTaskGetTickCount();
+	// Clear exactly flags handled below, new edge will call ISR again
+	GPIO_PortClearInterruptFlags( GPIO_IRQ_GPIO, l_mask );
 
-	// Switch PTC9
-	if ( l_mask & SW_PTC9_GPIO_PIN_MASK )
+	// only pins with flag, from the lowest one
+	for ( uint32_t l_pending = l_mask; l_pending; l_pending &= l_pending - 1 )
 	{
-		// RECOMMENDED SOLUTION!!!
-		// wakeup some process using semaphore
-		xSemaphoreGiveFromISR( g_sem_left_switch, nullptr );
-	}
+		uint32_t l_pin = __builtin_ctz( l_pending );
+		EdgeEvent l_event = { ( uint8_t ) l_pin, ( ( l_level >> l_pin ) & 1 ) != 0, l_cycles };
 
-	// Switch PTC10
-	if ( l_mask & SW_PTC10_GPIO_PIN_MASK )
-	{
-	}
+		if ( g_irq_callback[ l_pin ] )
+			g_irq_callback[ l_pin ]( &l_event, &l_woken );
 
-	// Switch PTC11
-	if ( l_mask & SW_PTC11_GPIO_PIN_MASK )
-	{
+		if ( g_edge_mask & ( 1U << l_pin ) )
+			l_pushed |= g_edge_ring.push( l_event );
 	}
 
-	// Switch PTC12
-	if ( l_mask & SW_PTC12_GPIO_PIN_MASK )
-	{
-		// INCORRECT SOLUTION!!!
-		// Direct changing global variable will not send any event to RTOS application
-		if ( g_red_led_index < 7 )
-			g_red_led_index++;
-
-		// Correct solution: use semaphore. See also Switch PTC9 above.
-		// xSemaphoreGiveFromISR( g_sem_right_switch, nullptr );
-	}
+	// one notification for all edges in ring
+	if ( l_pushed && g_edge_task )
+		vTaskNotifyGiveFromISR( g_edge_task, &l_woken );
 
-	// Clear interrupt flags
-    GPIO_PortClearInterruptFlags( SW_PTC9_GPIO,
-    		SW_PTC9_GPIO_PIN_MASK | SW_PTC10_GPIO_PIN_MASK | SW_PTC11_PIN_MASK | SW_PTC12_PIN_MASK );
+	portYIELD_FROM_ISR( l_woken );
 }
 
 // Initialize GPIO for interrupts
 void InitGPIOInterrupts()
 {
+	// Cycle counter for time stamps of edges
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
 	// Set correct priority
-    NVIC_SetPriority( PORTC_IRQn, 3 );
+    NVIC_SetPriority( GPIO_IRQ_IRQn, 3 );
+
+    // Enable interrupt
+    EnableIRQ( GPIO_IRQ_IRQn );
+}
+
+// Enable interrupt of PORTC pin
+bool GpioIrqEnable( uint32_t t_pin, port_interrupt_t t_edges, GpioIrqCallback t_callback )
+{
+	if ( t_pin >= GPIO_IRQ_PINS ) return false;
+
+	// callback must be ready before first interrupt
+	g_irq_callback[ t_pin ] = t_callback;
 
-    // Enable interrupt for switches
     // Available interrupt methods: kPORT_InterruptFallingEdge,kPORT_InterruptRisingEdge, kPORT_InterruptEitherEdge;
-    PORT_SetPinInterruptConfig( SW_PTC9_PORT, SW_PTC9_PIN, kPORT_InterruptFallingEdge );
-    PORT_SetPinInterruptConfig( SW_PTC9_PORT, SW_PTC10_PIN, kPORT_InterruptFallingEdge );
-    PORT_SetPinInterruptConfig( SW_PTC9_PORT, SW_PTC11_PIN, kPORT_InterruptFallingEdge );
-    PORT_SetPinInterruptConfig( SW_PTC9_PORT, SW_PTC12_PIN, kPORT_InterruptFallingEdge );
+	PORT_SetPinInterruptConfig( GPIO_IRQ_PORT, t_pin, t_edges );
+	return true;
+}
 
-    // Enable interrupt
-    EnableIRQ( PORTC_IRQn );
+// Edges of pins in t_pin_mask are stored into ring
+void GpioEdgeSubscribe( uint32_t t_pin_mask, TaskHandle_t t_task )
+{
+	taskENTER_CRITICAL();
+	g_edge_task = t_task;
+	g_edge_mask = t_pin_mask;
+	taskEXIT_CRITICAL();
+}
 
-    // Create binary semaphores
-    g_sem_left_switch = xSemaphoreCreateBinary();
-    g_sem_right_switch = xSemaphoreCreateBinary();
+// Read edge from ring
+bool GpioEdgeRead( EdgeEvent *t_event, TickType_t t_timeout )
+{
+	// notification is given after push, it can not be lost between pop and wait
+	while ( !g_edge_ring.pop( *t_event ) )
+	{
+		if ( !ulTaskNotifyTake( pdTRUE, t_timeout ) )
+			return g_edge_ring.pop( *t_event );
+	}
+	return true;
+}
+
+// Number of lost edges
+uint32_t GpioEdgeDropped()
+{
+	return g_edge_ring.dropped();
 }
@@ -11,15 +11,51 @@
 //
 // **************************************************************************
 //
+// One ISR serves all pins of PORTC. Every edge is one EdgeEvent with pin,
+// level after edge and DWT cycle counter at ISR entry. It is delivered:
+//
+// - to callback registered for pin by GpioIrqEnable(), callback runs
+//   in ISR and may use only ...FromISR() functions of FreeRTOS,
+// - to lock-free ring read by one task, if pin is in mask given to
+//   GpioEdgeSubscribe(). Reading task is woken by notification (index 0),
+//   so it must not wait for other notifications.
+//
+// ISR visits only pins with interrupt flag, so its duration does not
+// depend on number of registered pins.
+
+#ifndef GPIO_INTERRUPTS_H
+#define GPIO_INTERRUPTS_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "fsl_port.h"
 
-// Semaphores for synchronization ISR and application
-extern SemaphoreHandle_t g_sem_left_switch;
-extern SemaphoreHandle_t g_sem_right_switch;
+#define GPIO_IRQ_PINS			32
+#define GPIO_EDGE_RING_SIZE		32
 
-// Position of active red LED
-extern int32_t g_red_led_index;
+struct EdgeEvent
+{
+	uint8_t m_pin;
+	bool m_rising;			// pin level is 1 after edge
+	uint32_t m_cycles;		// DWT->CYCCNT at ISR entry
+};
+
+// Function called from ISR, set *t_woken when it wakes up some task
+typedef void ( *GpioIrqCallback )( const EdgeEvent *t_event, BaseType_t *t_woken );
 
 // Initialize GPIO for interrupts
 void InitGPIOInterrupts();
 
+// Enable interrupt of PORTC pin for t_edges, t_callback may be NULL
+bool GpioIrqEnable( uint32_t t_pin, port_interrupt_t t_edges, GpioIrqCallback t_callback );
+
+// Edges of pins in t_pin_mask are stored into ring for task t_task
+void GpioEdgeSubscribe( uint32_t t_pin_mask, TaskHandle_t t_task );
+
+// Read edge from ring, false on timeout
+bool GpioEdgeRead( EdgeEvent *t_event, TickType_t t_timeout );
+
+// Number of edges lost because ring was full
+uint32_t GpioEdgeDropped();
 
+#endif // GPIO_INTERRUPTS_H
@@ -0,0 +1,225 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Latency from interrupt to task measured by DWT cycle counter
+//
+// **************************************************************************
+//
+// FreeRTOS kernel includes.
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+// System includes.
+#include <stdlib.h>
+#include "board.h"
+#include "fsl_debug_console.h"
+#include "irq_latency.h"
+#include "static_alloc.h"
+
+#if IRQ_LATENCY_HARNESS
+
+#define TASK_NAME_LATENCY		"irq_latency"
+#define TASK_NAME_WAIT_SEM		"lat_wait_sem"
+#define TASK_NAME_WAIT_NOTIFY	"lat_wait_notify"
+
+#define LATENCY_IRQn			SWI_IRQn
+#define LATENCY_HIST_BUCKETS	24
+
+enum LatencyVariant
+{
+	LAT_SEM,
+	LAT_SEM_YIELD,
+	LAT_NOTIFY,
+	LAT_NOTIFY_YIELD,
+	LAT_VARIANTS
+};
+
+static const char * const g_lat_name[ LAT_VARIANTS ] =
+		{ "semaphore", "semaphore+yield", "notify", "notify+yield" };
+
+static volatile uint32_t g_lat_variant;
+static SemaphoreHandle_t g_lat_sem;
+static TaskHandle_t g_lat_wait_sem, g_lat_wait_notify;
+
+// Time stamps of one sample
+static volatile uint32_t g_lat_pend, g_lat_entry, g_lat_given;
+static volatile bool g_lat_done;
+
+// Results of one variant
+static uint32_t g_lat_total[ IRQ_LATENCY_SAMPLES ];
+static uint32_t g_lat_entry_sum, g_lat_give_sum;
+static volatile uint32_t g_lat_count;
+
+extern "C" {
+void SWI_IRQHandler(void);
+}
+
+// ISR of software interrupt, wakes up waiting task by selected variant
+void SWI_IRQHandler(void)
+{
+	g_lat_entry = DWT->CYCCNT;
+	BaseType_t l_woken = pdFALSE;
+
+	switch ( g_lat_variant )
+	{
+	case LAT_SEM:
+		xSemaphoreGiveFromISR( g_lat_sem, nullptr );
+		break;
+	case LAT_SEM_YIELD:
+		xSemaphoreGiveFromISR( g_lat_sem, &l_woken );
+		break;
+	case LAT_NOTIFY:
+		vTaskNotifyGiveFromISR( g_lat_wait_notify, nullptr );
+		break;
+	case LAT_NOTIFY_YIELD:
+		vTaskNotifyGiveFromISR( g_lat_wait_notify, &l_woken );
+		break;
+	}
+
+	g_lat_given = DWT->CYCCNT;
+
+	portYIELD_FROM_ISR( l_woken );
+}
+
+// Store time stamps of sample, called by waiting task after resume
+static void latency_sample( uint32_t t_resume )
+{
+	if ( g_lat_count < IRQ_LATENCY_SAMPLES )
+	{
+		g_lat_total[ g_lat_count ] = t_resume - g_lat_pend;
+		g_lat_entry_sum += g_lat_entry - g_lat_pend;
+		g_lat_give_sum += g_lat_given - g_lat_entry;
+		g_lat_count++;
+	}
+	g_lat_done = true;
+}
+
+void task_lat_wait_sem( void *t_arg )
+{
+	while ( 1 )
+	{
+		xSemaphoreTake( g_lat_sem, portMAX_DELAY );
+		latency_sample( DWT->CYCCNT );
+	}
+}
+
+void task_lat_wait_notify( void *t_arg )
+{
+	while ( 1 )
+	{
+		ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+		latency_sample( DWT->CYCCNT );
+	}
+}
+
+static int latency_compare( const void *t_a, const void *t_b )
+{
+	uint32_t l_a = *( const uint32_t * ) t_a, l_b = *( const uint32_t * ) t_b;
+	return l_a < l_b ? -1 : l_a > l_b;
+}
+
+// Print statistics and log2 histogram of pend -> resume
+static void latency_print( uint32_t t_variant )
+{
+	uint32_t l_n = g_lat_count;
+	uint32_t l_hist[ LATENCY_HIST_BUCKETS ] = { 0 };
+	uint64_t l_sum = 0;
+
+	qsort( g_lat_total, l_n, sizeof( g_lat_total[ 0 ] ), latency_compare );
+
+	for ( uint32_t i = 0; i < l_n; i++ )
+	{
+		l_sum += g_lat_total[ i ];
+		uint32_t l_bucket = 31 - __builtin_clz( g_lat_total[ i ] | 1 );
+		l_hist[ l_bucket < LATENCY_HIST_BUCKETS ? l_bucket : LATENCY_HIST_BUCKETS - 1 ]++;
+	}
+
+	PRINTF( "%-16s min %u avg %u p99 %u max %u cycles (pend->entry avg %u, give in ISR avg %u)\r\n",
+			g_lat_name[ t_variant ], g_lat_total[ 0 ], ( uint32_t ) ( l_sum / l_n ),
+			g_lat_total[ l_n * 99 / 100 ], g_lat_total[ l_n - 1 ],
+			g_lat_entry_sum / l_n, g_lat_give_sum / l_n );
+
+	for ( uint32_t b = 0; b < LATENCY_HIST_BUCKETS; b++ )
+	{
+		if ( l_hist[ b ] )
+			PRINTF( "  %8u..%8u cycles: %u\r\n", 1U << b, ( 2U << b ) - 1, l_hist[ b ] );
+	}
+}
+
+// Harness task, runs all variants once and deletes itself
+void task_irq_latency( void *t_arg )
+{
+	uint32_t l_tick_cycles = SystemCoreClock / configTICK_RATE_HZ;
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	// same priority as PORTC of switches
+	NVIC_SetPriority( LATENCY_IRQn, 3 );
+	EnableIRQ( LATENCY_IRQn );
+
+	PRINTF( "IRQ latency, %d samples, %u cycles per us:\r\n", IRQ_LATENCY_SAMPLES, SystemCoreClock / 1000000 );
+
+	for ( uint32_t v = 0; v < LAT_VARIANTS; v++ )
+	{
+		g_lat_variant = v;
+		g_lat_count = 0;
+		g_lat_entry_sum = g_lat_give_sum = 0;
+
+		for ( uint32_t i = 0; i < IRQ_LATENCY_SAMPLES; i++ )
+		{
+			// start in new tick and move pend through whole tick
+			vTaskDelay( 1 );
+			uint32_t l_start = DWT->CYCCNT;
+			uint32_t l_phase = ( i * 7919 ) % ( l_tick_cycles / 2 );
+			while ( DWT->CYCCNT - l_start < l_phase );
+
+			g_lat_done = false;
+			g_lat_pend = DWT->CYCCNT;
+			NVIC_SetPendingIRQ( LATENCY_IRQn );
+
+			// busy, as task interrupted by edge of switch
+			l_start = DWT->CYCCNT;
+			while ( !g_lat_done && DWT->CYCCNT - l_start < 4 * l_tick_cycles );
+		}
+
+		if ( g_lat_count )
+			latency_print( v );
+		else
+			PRINTF( "%-16s no sample!\r\n", g_lat_name[ v ] );
+	}
+
+	DisableIRQ( LATENCY_IRQn );
+	vTaskDelete( g_lat_wait_sem );
+	vTaskDelete( g_lat_wait_notify );
+	vTaskDelete( NULL );
+}
+
+// Create harness and waiting tasks
+void IrqLatencyRun( UBaseType_t t_priority )
+{
+	g_lat_sem = APP_SEMAPHORE_CREATE_BINARY( latency );
+
+	if ( APP_TASK_CREATE( task_lat_wait_sem, TASK_NAME_WAIT_SEM, configMINIMAL_STACK_SIZE, NULL, t_priority + 1, &g_lat_wait_sem ) != pdPASS )
+	{
+		PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_WAIT_SEM );
+	}
+
+	if ( APP_TASK_CREATE( task_lat_wait_notify, TASK_NAME_WAIT_NOTIFY, configMINIMAL_STACK_SIZE, NULL, t_priority + 1, &g_lat_wait_notify ) != pdPASS )
+	{
+		PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_WAIT_NOTIFY );
+	}
+
+	if ( APP_TASK_CREATE( task_irq_latency, TASK_NAME_LATENCY, configMINIMAL_STACK_SIZE + 100, NULL, t_priority, NULL ) != pdPASS )
+	{
+		PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_LATENCY );
+	}
+}
+
+#endif // IRQ_LATENCY_HARNESS
@@ -0,0 +1,44 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Latency from interrupt to task measured by DWT cycle counter
+//
+// **************************************************************************
+//
+// Harness task pends software interrupt SWI (same NVIC priority as PORTC)
+// and busy waits, as any task interrupted by switch edge. ISR wakes up
+// waiting task by one of variants:
+//
+// semaphore          xSemaphoreGiveFromISR( sem, nullptr ), no yield
+// semaphore+yield    xSemaphoreGiveFromISR( sem, &woken ) + portYIELD_FROM_ISR
+// notify             vTaskNotifyGiveFromISR( task, nullptr ), no yield
+// notify+yield       vTaskNotifyGiveFromISR( task, &woken ) + portYIELD_FROM_ISR
+//
+// DWT->CYCCNT is stamped at pend, ISR entry, after give in ISR and when
+// task resumes. Every variant prints min/avg/p99/max of pend -> resume
+// and log2 histogram of it. Without yield task waits for next tick, so
+// phase of pend within tick is varied from sample to sample.
+
+#ifndef IRQ_LATENCY_H
+#define IRQ_LATENCY_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Set to 1 to measure wakeup variants at startup and print latency of
+// every left switch press
+#define IRQ_LATENCY_HARNESS		0
+
+#define IRQ_LATENCY_SAMPLES		256
+
+#if IRQ_LATENCY_HARNESS
+// Create harness task, waiting tasks get t_priority + 1
+void IrqLatencyRun( UBaseType_t t_priority );
+#endif
+
+#endif // IRQ_LATENCY_H
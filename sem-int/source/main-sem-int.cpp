@@ -63,6 +63,9 @@
 
 // Application includes
 #include "gpio_interrupts.h"
+#include "static_alloc.h"
+#include "cpu_load.h"
+#include "irq_latency.h"
 
 // Task priorities.
 #define LOW_TASK_PRIORITY 		(configMAX_PRIORITIES - 2)
@@ -72,6 +75,12 @@
 #define TASK_NAME_RED_LED		"red led"
 #define TASK_NAME_LEFT_SWITCH	"left switch"
 #define TASK_NAME_RIGHT_SWITCH	"right switch"
+#define TASK_NAME_EDGE_LOG		"edge log"
+
+// Time in ms after start when red LED task checks position every tick as
+// the old task did, then it waits for notifications. One boot prints CPU
+// load of both ways, e.g. ( 3 * CPU_LOAD_PERIOD_MS ). 0 = notifications only.
+#define RED_LED_POLLING_MS		0
 
 #define LED_PTA_NUM 	2
 #define LED_PTC_NUM		8
@@ -101,8 +110,40 @@ LED_Data g_led_ptc[ LED_PTC_NUM ] =
 SemaphoreHandle_t g_sem_left_switch;
 SemaphoreHandle_t g_sem_right_switch;
 
+// Position of active red LED, notification value of g_red_led_task
 int32_t g_red_led_index = 0;
+TaskHandle_t g_red_led_task = NULL;
+
+#if IRQ_LATENCY_HARNESS
+// Time of last edge of left switch in CPU cycles
+volatile uint32_t g_left_switch_cycles;
+#endif
+
+
+// Interrupt callbacks
+
+// Switch PTC9
+void isr_left_switch( const EdgeEvent *t_event, BaseType_t *t_woken )
+{
+	// RECOMMENDED SOLUTION!!!
+	// wakeup some process using semaphore
+#if IRQ_LATENCY_HARNESS
+	g_left_switch_cycles = t_event->m_cycles;
+#endif
+	xSemaphoreGiveFromISR( g_sem_left_switch, t_woken );
+}
+
+// Switch PTC12
+void isr_right_switch( const EdgeEvent *t_event, BaseType_t *t_woken )
+{
+	// Changing global variable alone will not send any event to RTOS application,
+	// red LED task gets new position as notification value.
+	if ( g_red_led_index < LED_PTC_NUM - 1 )
+		g_red_led_index++;
 
+	if ( g_red_led_task )
+		xTaskNotifyFromISR( g_red_led_task, g_red_led_index, eSetValueWithOverwrite, t_woken );
+}
 
 // Tasks
 void task_left_switch( void *t_arg )
@@ -111,36 +152,97 @@ void task_left_switch( void *t_arg )
 	{
 		xSemaphoreTake( g_sem_left_switch, portMAX_DELAY );
 
+#if IRQ_LATENCY_HARNESS
+		uint32_t l_latency = DWT->CYCCNT - g_left_switch_cycles;
+#endif
+
+		// PORTC ISR must not change position between store and notification,
+		// only its interrupt is masked, xTaskNotify() may switch context
+		DisableIRQ( PORTC_IRQn );
 		g_red_led_index = 0;
+		xTaskNotify( g_red_led_task, 0, eSetValueWithOverwrite );
+		EnableIRQ( PORTC_IRQn );
+
+#if IRQ_LATENCY_HARNESS
+		PRINTF( "Left switch reached task in %u cycles.\r\n", l_latency );
+#endif
 
 		vTaskDelay( 1 );
 	}
 }
 
+// Show red LED at position from notification value
+void show_red_led( int32_t t_index, int32_t *t_last_index )
+{
+	// check range of position
+	if ( t_index >= LED_PTC_NUM )
+		t_index = LED_PTC_NUM - 1;
+	if ( t_index < 0 )
+		t_index = 0;
+
+	// position changed?
+	if ( *t_last_index != t_index )
+	{
+		if ( *t_last_index < 0 ) *t_last_index = t_index;
+
+		GPIO_PinWrite( g_led_ptc[ *t_last_index ].m_led_gpio, g_led_ptc[ *t_last_index ].m_led_pin, 0 );
+		GPIO_PinWrite( g_led_ptc[ t_index ].m_led_gpio, g_led_ptc[ t_index ].m_led_pin, 1 );
+
+		*t_last_index = t_index;
+	}
+}
+
+// Task is blocked until position is changed
 void task_show_red_led( void *t_arg )
 {
 	int32_t l_last_index = -1;
 
+#if RED_LED_POLLING_MS
+	// old way for comparison of CPU load, position is checked in every tick
+	PRINTF( "Red LED checks position every tick for %u ms.\r\n", RED_LED_POLLING_MS );
+	TickType_t l_start = xTaskGetTickCount();
+	while ( xTaskGetTickCount() - l_start < pdMS_TO_TICKS( RED_LED_POLLING_MS ) )
+	{
+		show_red_led( g_red_led_index, &l_last_index );
+		vTaskDelay( 1 );
+	}
+	PRINTF( "Red LED waits for notifications.\r\n" );
+#endif // RED_LED_POLLING_MS
+
+	// notification pending from polling carries the latest position too
+	uint32_t l_index = g_red_led_index;
+
 	while ( 1 )
 	{
-		// check range of g_red_led_index
-		if ( g_red_led_index >= LED_PTC_NUM )
-			g_red_led_index = LED_PTC_NUM - 1;
-		if ( g_red_led_index < 0 )
-			g_red_led_index = 0;
-
-		// position changed?
-		if ( l_last_index != g_red_led_index )
-		{
-			if ( l_last_index < 0 ) l_last_index = g_red_led_index;
+		show_red_led( l_index, &l_last_index );
 
-			GPIO_PinWrite( g_led_ptc[ l_last_index ].m_led_gpio, g_led_ptc[ l_last_index ].m_led_pin, 0 );
-			GPIO_PinWrite( g_led_ptc[ g_red_led_index ].m_led_gpio, g_led_ptc[ g_red_led_index ].m_led_pin, 1 );
+		// new position is notification value, no bits to clear
+		xTaskNotifyWait( 0, 0, &l_index, portMAX_DELAY );
+	}
+}
 
-			l_last_index = g_red_led_index;
-		}
+// Print edges of switches PTC10 and PTC11 from ring of GPIO interrupts
+void task_edge_log( void *t_arg )
+{
+	EdgeEvent l_event;
+	uint32_t l_last_cycles = 0;
+	uint32_t l_dropped = 0;
+	uint32_t l_cycles_us = SystemCoreClock / 1000000;
 
-		vTaskDelay( 1 );
+	while ( 1 )
+	{
+		GpioEdgeRead( &l_event, portMAX_DELAY );
+
+		// switches are active in 0
+		PRINTF( "Switch PTC%d %s, %u us after previous edge.\r\n", l_event.m_pin,
+				l_event.m_rising ? "released" : "pressed", ( l_event.m_cycles - l_last_cycles ) / l_cycles_us );
+		l_last_cycles = l_event.m_cycles;
+
+		if ( GpioEdgeDropped() != l_dropped )
+		{
+			l_dropped = GpioEdgeDropped();
+			PRINTF( "%u edges lost, ring of edges was full.\r\n", l_dropped );
+		}
 	}
 }
 
@@ -153,17 +255,19 @@ int main( void ) {
     BOARD_InitBootPeripherals();
     BOARD_InitDebugConsole();
 
-    // Initialize GPIO for interrupts
-    InitGPIOInterrupts();
+    // Create binary semaphores
+    g_sem_left_switch = APP_SEMAPHORE_CREATE_BINARY( left_switch );
+    g_sem_right_switch = APP_SEMAPHORE_CREATE_BINARY( right_switch );
 
     PRINTF( "FreeRTOS demo program uses interrupts (ISR) and semaphores.\r\n" );
     PRINTF( "GPIO interrupts are enabled.\r\n" );
     PRINTF( "Interrupts are generated by switches, see 'gpio_interrupts.cpp' file.\r\n" );
     PRINTF( "Pressing the right switch will move red LED to right.\r\n" );
     PRINTF( "Pressing the left switch will move red LED back to left side.\r\n" );
+    PRINTF( "Presses and releases of switches PTC10 and PTC11 are printed with their time.\r\n" );
 
     // Create tasks
-    if ( xTaskCreate(
+    if ( APP_TASK_CREATE(
     		task_left_switch,
 			TASK_NAME_LEFT_SWITCH,
 			configMINIMAL_STACK_SIZE + 100,
@@ -174,11 +278,32 @@ int main( void ) {
         PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_LEFT_SWITCH );
     }
 
-    if ( xTaskCreate( task_show_red_led, TASK_NAME_RED_LED, configMINIMAL_STACK_SIZE + 100, NULL, HIGH_TASK_PRIORITY, NULL) != pdPASS )
+    if ( APP_TASK_CREATE( task_show_red_led, TASK_NAME_RED_LED, configMINIMAL_STACK_SIZE + 100, NULL, HIGH_TASK_PRIORITY, &g_red_led_task) != pdPASS )
     {
         PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_RED_LED );
     }
 
+    TaskHandle_t l_edge_log;
+
+    if ( APP_TASK_CREATE( task_edge_log, TASK_NAME_EDGE_LOG, configMINIMAL_STACK_SIZE + 100, NULL, LOW_TASK_PRIORITY, &l_edge_log) != pdPASS )
+    {
+        PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_EDGE_LOG );
+    }
+
+    CpuLoadInit( CPU_LOAD_PERIOD_MS, NORMAL_TASK_PRIORITY );
+
+#if IRQ_LATENCY_HARNESS
+    IrqLatencyRun( LOW_TASK_PRIORITY );
+#endif
+
+    // Initialize GPIO for interrupts, all objects used by callbacks are ready
+    InitGPIOInterrupts();
+    GpioIrqEnable( SW_PTC9_PIN, kPORT_InterruptFallingEdge, isr_left_switch );
+    GpioIrqEnable( SW_PTC12_PIN, kPORT_InterruptFallingEdge, isr_right_switch );
+    GpioIrqEnable( SW_PTC10_PIN, kPORT_InterruptEitherEdge, NULL );
+    GpioIrqEnable( SW_PTC11_PIN, kPORT_InterruptEitherEdge, NULL );
+    GpioEdgeSubscribe( SW_PTC10_GPIO_PIN_MASK | SW_PTC11_GPIO_PIN_MASK, l_edge_log );
+
     vTaskStartScheduler();
 
     while ( 1 );
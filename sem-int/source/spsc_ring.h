@@ -0,0 +1,84 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Lock-free ring buffer for one producer and one consumer
+//
+// **************************************************************************
+//
+// Producer (usually ISR) only writes m_head, consumer (task) only writes
+// m_tail, so neither side needs lock or disabled interrupts. Indexes run
+// freely and wrap at 2^32, size of ring must be power of 2.
+//
+// Item which does not fit into full ring is dropped and counted.
+// Header does not depend on FreeRTOS nor on board, it can be used on host,
+// tools/spsc_ring_test.cpp tests it with bursts of edges.
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <atomic>
+
+template < typename t_item, uint32_t t_size >
+class SpscRing
+{
+	static_assert( t_size && !( t_size & ( t_size - 1 ) ), "Size of ring must be power of 2" );
+
+public:
+	SpscRing() : m_head( 0 ), m_tail( 0 ), m_dropped( 0 ) {}
+
+	// Empty ring with indexes starting at t_start, host test of wrap
+	explicit SpscRing( uint32_t t_start ) : m_head( t_start ), m_tail( t_start ), m_dropped( 0 ) {}
+
+	// Producer side, false if ring is full
+	bool push( const t_item &t_it )
+	{
+		uint32_t l_head = m_head.load( std::memory_order_relaxed );
+
+		if ( l_head - m_tail.load( std::memory_order_acquire ) == t_size )
+		{
+			m_dropped.store( m_dropped.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+			return false;
+		}
+
+		m_items[ l_head & ( t_size - 1 ) ] = t_it;
+		// item must be written before it is visible to consumer
+		m_head.store( l_head + 1, std::memory_order_release );
+		return true;
+	}
+
+	// Consumer side, false if ring is empty
+	bool pop( t_item &t_it )
+	{
+		uint32_t l_tail = m_tail.load( std::memory_order_relaxed );
+
+		if ( l_tail == m_head.load( std::memory_order_acquire ) )
+			return false;
+
+		t_it = m_items[ l_tail & ( t_size - 1 ) ];
+		// item must be read before producer may overwrite it
+		m_tail.store( l_tail + 1, std::memory_order_release );
+		return true;
+	}
+
+	uint32_t count() const
+	{
+		return m_head.load( std::memory_order_acquire ) - m_tail.load( std::memory_order_acquire );
+	}
+
+	// Number of items dropped since start
+	uint32_t dropped() const { return m_dropped.load( std::memory_order_relaxed ); }
+
+private:
+	t_item m_items[ t_size ];
+	std::atomic< uint32_t > m_head;
+	std::atomic< uint32_t > m_tail;
+	std::atomic< uint32_t > m_dropped;
+};
+
+#endif // SPSC_RING_H
@@ -55,6 +55,7 @@
 #define configUSE_16_BIT_TICKS                  0
 #define configIDLE_SHOULD_YIELD                 1
 #define configUSE_TASK_NOTIFICATIONS            1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES   2
 #define configUSE_MUTEXES                       1
 #define configUSE_RECURSIVE_MUTEXES             1
 #define configUSE_COUNTING_SEMAPHORES           1
@@ -68,9 +69,18 @@
 #define configUSE_APPLICATION_TASK_TAG          0
 
 /* Memory allocation related definitions. */
-#define configSUPPORT_STATIC_ALLOCATION         0
+/* Application tasks and kernel objects in static memory, see static_alloc.h */
+#ifndef APP_STATIC_ALLOCATION
+#define APP_STATIC_ALLOCATION                   1
+#endif
+#define configSUPPORT_STATIC_ALLOCATION         APP_STATIC_ALLOCATION
 #define configSUPPORT_DYNAMIC_ALLOCATION        1
+#if APP_STATIC_ALLOCATION
+/* Heap is needed only for objects created at run time */
+#define configTOTAL_HEAP_SIZE                   ((size_t)(1024))
+#else
 #define configTOTAL_HEAP_SIZE                   ((size_t)(10240))
+#endif
 #define configAPPLICATION_ALLOCATED_HEAP        0
 
 /* Hook function related definitions. */
@@ -107,11 +117,11 @@
 #define INCLUDE_vTaskDelay                      1
 #define INCLUDE_xTaskGetSchedulerState          1
 #define INCLUDE_xTaskGetCurrentTaskHandle       1
-#define INCLUDE_uxTaskGetStackHighWaterMark     0
+#define INCLUDE_uxTaskGetStackHighWaterMark     1
 #define INCLUDE_xTaskGetIdleTaskHandle          0
 #define INCLUDE_eTaskGetState                   0
 #define INCLUDE_xTimerPendFunctionCall          0
-#define INCLUDE_xTaskAbortDelay                 0
+#define INCLUDE_xTaskAbortDelay                 1
 #define INCLUDE_xTaskGetHandle                  1
 #define INCLUDE_xTaskResumeFromISR              1
 
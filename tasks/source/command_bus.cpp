@@ -0,0 +1,128 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Commands for tasks by direct task notifications
+//
+// **************************************************************************
+//
+// FreeRTOS kernel includes.
+#include "FreeRTOS.h"
+#include "task.h"
+
+// System includes.
+#include "board.h"
+#include "fsl_debug_console.h"
+#include "command_bus.h"
+#include "static_alloc.h"
+
+static TaskHandle_t g_cmd_endpoint[ COMMAND_BUS_ENDPOINTS ];
+
+// Register task for endpoint
+bool CommandBusRegister( uint32_t t_endpoint, TaskHandle_t t_task )
+{
+	if ( t_endpoint >= COMMAND_BUS_ENDPOINTS || !t_task ) return false;
+
+	g_cmd_endpoint[ t_endpoint ] = t_task;
+	return true;
+}
+
+// Send commands to endpoint
+bool CommandBusSend( uint32_t t_endpoint, uint32_t t_commands )
+{
+	if ( t_endpoint >= COMMAND_BUS_ENDPOINTS || !g_cmd_endpoint[ t_endpoint ] ) return false;
+
+	xTaskNotifyIndexed( g_cmd_endpoint[ t_endpoint ], COMMAND_BUS_INDEX, t_commands, eSetBits );
+	return true;
+}
+
+// Send commands to endpoint from ISR
+bool CommandBusSendFromISR( uint32_t t_endpoint, uint32_t t_commands, BaseType_t *t_woken )
+{
+	if ( t_endpoint >= COMMAND_BUS_ENDPOINTS || !g_cmd_endpoint[ t_endpoint ] ) return false;
+
+	xTaskNotifyIndexedFromISR( g_cmd_endpoint[ t_endpoint ], COMMAND_BUS_INDEX, t_commands, eSetBits, t_woken );
+	return true;
+}
+
+// Wait for commands of calling task
+uint32_t CommandBusWait( TickType_t t_timeout )
+{
+	uint32_t l_commands = 0;
+
+	// clear all bits on exit, every command is received only once
+	xTaskNotifyWaitIndexed( COMMAND_BUS_INDEX, 0, UINT32_MAX, &l_commands, t_timeout );
+
+	return l_commands;
+}
+
+#if COMMAND_BUS_BENCHMARK
+
+#define BENCHMARK_ROUNDS		1000
+#define BENCHMARK_ENDPOINT		( COMMAND_BUS_ENDPOINTS - 1 )
+#define TASK_NAME_BENCH_RESUME	"bench_resume"
+#define TASK_NAME_BENCH_NOTIFY	"bench_notify"
+
+static void task_bench_resume( void *t_arg )
+{
+	while ( 1 )
+		vTaskSuspend( NULL );
+}
+
+static void task_bench_notify( void *t_arg )
+{
+	while ( 1 )
+		CommandBusWait( portMAX_DELAY );
+}
+
+// Benchmark task has lower priority than both receivers,
+// so every round is complete switch to receiver and back.
+static void task_bench( void *t_arg )
+{
+	UBaseType_t l_prio = uxTaskPriorityGet( NULL ) + 1;
+	TaskHandle_t l_resume, l_notify;
+	uint32_t l_start, l_cycles;
+
+	APP_TASK_CREATE( task_bench_resume, TASK_NAME_BENCH_RESUME, configMINIMAL_STACK_SIZE, NULL, l_prio, &l_resume );
+	APP_TASK_CREATE( task_bench_notify, TASK_NAME_BENCH_NOTIFY, configMINIMAL_STACK_SIZE, NULL, l_prio, &l_notify );
+	CommandBusRegister( BENCHMARK_ENDPOINT, l_notify );
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	l_start = DWT->CYCCNT;
+	for ( int i = 0; i < BENCHMARK_ROUNDS; i++ )
+		xTaskGetHandle( TASK_NAME_BENCH_RESUME );
+	l_cycles = DWT->CYCCNT - l_start;
+	PRINTF( "xTaskGetHandle: %u cycles.\r\n", l_cycles / BENCHMARK_ROUNDS );
+
+	l_start = DWT->CYCCNT;
+	for ( int i = 0; i < BENCHMARK_ROUNDS; i++ )
+		vTaskResume( l_resume );
+	l_cycles = DWT->CYCCNT - l_start;
+	PRINTF( "vTaskResume + vTaskSuspend: %u cycles.\r\n", l_cycles / BENCHMARK_ROUNDS );
+
+	l_start = DWT->CYCCNT;
+	for ( int i = 0; i < BENCHMARK_ROUNDS; i++ )
+		CommandBusSend( BENCHMARK_ENDPOINT, 1 );
+	l_cycles = DWT->CYCCNT - l_start;
+	PRINTF( "CommandBusSend + CommandBusWait: %u cycles.\r\n", l_cycles / BENCHMARK_ROUNDS );
+
+	vTaskDelete( l_resume );
+	vTaskDelete( l_notify );
+	g_cmd_endpoint[ BENCHMARK_ENDPOINT ] = NULL;
+	vTaskDelete( NULL );
+}
+
+// Create task which measures notifications and suspend/resume
+void CommandBusBenchmark( UBaseType_t t_priority )
+{
+	APP_TASK_CREATE( task_bench, "bench", configMINIMAL_STACK_SIZE + 100, NULL, t_priority, NULL );
+}
+
+#endif // COMMAND_BUS_BENCHMARK
@@ -0,0 +1,54 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Commands for tasks by direct task notifications
+//
+// **************************************************************************
+//
+// Every task receiving commands is registered once with its endpoint
+// number. Commands are bit flags, sending is xTaskNotifyIndexed() with
+// eSetBits, so command sent before receiver waits is not lost and burst
+// of the same command is delivered as one bit.
+//
+// Notification index COMMAND_BUS_INDEX is used only by this module,
+// index 0 stays free for other notifications.
+
+#ifndef COMMAND_BUS_H
+#define COMMAND_BUS_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define COMMAND_BUS_INDEX			1
+#define COMMAND_BUS_ENDPOINTS		8
+
+// Set to 1 to compare notifications with vTaskSuspend/vTaskResume at startup
+#define COMMAND_BUS_BENCHMARK		0
+
+#if COMMAND_BUS_INDEX >= configTASK_NOTIFICATION_ARRAY_ENTRIES
+#error configTASK_NOTIFICATION_ARRAY_ENTRIES is too small for COMMAND_BUS_INDEX
+#endif
+
+// Register task for endpoint, call once after task creation
+bool CommandBusRegister( uint32_t t_endpoint, TaskHandle_t t_task );
+
+// Send commands to endpoint
+bool CommandBusSend( uint32_t t_endpoint, uint32_t t_commands );
+
+// Send commands to endpoint from ISR
+bool CommandBusSendFromISR( uint32_t t_endpoint, uint32_t t_commands, BaseType_t *t_woken );
+
+// Wait for commands of calling task, returns all received command bits or 0 on timeout
+uint32_t CommandBusWait( TickType_t t_timeout );
+
+#if COMMAND_BUS_BENCHMARK
+// Create task which measures notifications and suspend/resume and prints results
+void CommandBusBenchmark( UBaseType_t t_priority );
+#endif
+
+#endif // COMMAND_BUS_H
@@ -0,0 +1,199 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Switch gesture recognizer
+//
+// **************************************************************************
+//
+#include "gesture_recognizer.h"
+
+// Time difference which survives overflow of time counter
+static inline int32_t time_diff( uint32_t t_later, uint32_t t_earlier )
+{
+	return ( int32_t ) ( t_later - t_earlier );
+}
+
+static void gesture_fill( Gesture *t_out, GestureType t_type, uint32_t t_switch, uint8_t t_mask, uint32_t t_time )
+{
+	t_out->m_type = t_type;
+	t_out->m_switch = ( uint8_t ) t_switch;
+	t_out->m_mask = t_mask;
+	t_out->m_time = t_time;
+}
+
+// Reset all switches
+void GestureInit( GestureRecognizer *t_rec, uint8_t t_double_click_mask, uint8_t t_early_click_mask )
+{
+	for ( int i = 0; i < GESTURE_SWITCHES; i++ )
+	{
+		t_rec->m_switch[ i ].m_state = SwitchState::Idle;
+		t_rec->m_switch[ i ].m_level = false;
+		t_rec->m_switch[ i ].m_raw_level = false;
+		t_rec->m_switch[ i ].m_edge_time = 0;
+		t_rec->m_switch[ i ].m_press_time = 0;
+	}
+	t_rec->m_double_click_mask = t_double_click_mask;
+	t_rec->m_early_click_mask = t_early_click_mask & t_double_click_mask;
+}
+
+// Accept new level of switch
+static int gesture_level( GestureRecognizer *t_rec, uint32_t t_switch, bool t_pressed, uint32_t t_time, Gesture *t_out )
+{
+	SwitchData *l_sw = &t_rec->m_switch[ t_switch ];
+
+	l_sw->m_level = t_pressed;
+	l_sw->m_edge_time = t_time;
+
+	if ( t_pressed )
+	{
+		if ( l_sw->m_state == SwitchState::WaitSecond )
+		{
+			// second press in time, rest of gesture is ignored
+			l_sw->m_state = SwitchState::Suppressed;
+			gesture_fill( t_out, GestureType::DoubleClick, t_switch, 1U << t_switch, t_time );
+			return 1;
+		}
+
+		// other switch pressed a moment ago?
+		uint8_t l_mask = 0;
+		uint32_t l_first = t_switch;
+		for ( uint32_t i = 0; i < GESTURE_SWITCHES; i++ )
+		{
+			SwitchData *l_other = &t_rec->m_switch[ i ];
+			if ( i == t_switch || l_other->m_state != SwitchState::Pressed ) continue;
+			if ( time_diff( t_time, l_other->m_press_time ) > GESTURE_CHORD_MS ) continue;
+
+			if ( !l_mask || time_diff( l_other->m_press_time, t_rec->m_switch[ l_first ].m_press_time ) < 0 )
+				l_first = i;
+			l_mask |= 1U << i;
+		}
+
+		l_sw->m_press_time = t_time;
+
+		if ( l_mask )
+		{
+			l_mask |= 1U << t_switch;
+			for ( uint32_t i = 0; i < GESTURE_SWITCHES; i++ )
+				if ( l_mask & ( 1U << i ) )
+					t_rec->m_switch[ i ].m_state = SwitchState::Suppressed;
+
+			gesture_fill( t_out, GestureType::Chord, l_first, l_mask, t_time );
+			return 1;
+		}
+
+		l_sw->m_state = SwitchState::Pressed;
+		return 0;
+	}
+
+	// release
+	if ( l_sw->m_state == SwitchState::Pressed )
+	{
+		if ( t_rec->m_double_click_mask & ( 1U << t_switch ) )
+		{
+			l_sw->m_state = SwitchState::WaitSecond;
+			if ( !( t_rec->m_early_click_mask & ( 1U << t_switch ) ) ) return 0;
+
+			gesture_fill( t_out, GestureType::Click, t_switch, 1U << t_switch, t_time );
+			return 1;
+		}
+
+		l_sw->m_state = SwitchState::Idle;
+		gesture_fill( t_out, GestureType::Click, t_switch, 1U << t_switch, t_time );
+		return 1;
+	}
+
+	if ( l_sw->m_state == SwitchState::Suppressed )
+		l_sw->m_state = SwitchState::Idle;
+
+	return 0;
+}
+
+// Process one edge of switch
+int GestureEdge( GestureRecognizer *t_rec, uint32_t t_switch, bool t_pressed, uint32_t t_time, Gesture *t_out )
+{
+	if ( t_switch >= GESTURE_SWITCHES ) return 0;
+
+	// deadline which expired before edge must not see it
+	int l_count = GestureTimeout( t_rec, t_time, t_out );
+
+	SwitchData *l_sw = &t_rec->m_switch[ t_switch ];
+	l_sw->m_raw_level = t_pressed;
+
+	// no change of level or bounce, GestureTimeout() samples level later
+	if ( l_sw->m_level == t_pressed ) return l_count;
+	if ( time_diff( t_time, l_sw->m_edge_time ) < GESTURE_DEBOUNCE_MS ) return l_count;
+
+	return l_count + gesture_level( t_rec, t_switch, t_pressed, t_time, &t_out[ l_count ] );
+}
+
+// Process expired deadlines and debounce windows
+int GestureTimeout( GestureRecognizer *t_rec, uint32_t t_time, Gesture *t_out )
+{
+	int l_count = 0;
+
+	for ( uint32_t i = 0; i < GESTURE_SWITCHES; i++ )
+	{
+		SwitchData *l_sw = &t_rec->m_switch[ i ];
+
+		// level changed by the last bounce is stable now
+		if ( l_sw->m_raw_level != l_sw->m_level && time_diff( t_time, l_sw->m_edge_time ) >= GESTURE_DEBOUNCE_MS )
+		{
+			int l_new = gesture_level( t_rec, i, l_sw->m_raw_level, t_time, &t_out[ l_count ] );
+			l_count += l_new;
+			if ( l_new ) continue;
+		}
+
+		int32_t l_held = time_diff( t_time, l_sw->m_press_time );
+
+		if ( l_sw->m_state == SwitchState::Pressed && l_held >= GESTURE_LONG_PRESS_MS )
+		{
+			l_sw->m_state = SwitchState::Suppressed;
+			gesture_fill( &t_out[ l_count++ ], GestureType::LongPress, i, 1U << i, t_time );
+		}
+		else if ( l_sw->m_state == SwitchState::WaitSecond && l_held >= GESTURE_DOUBLE_CLICK_MS )
+		{
+			l_sw->m_state = SwitchState::Idle;
+			if ( !( t_rec->m_early_click_mask & ( 1U << i ) ) )
+				gesture_fill( &t_out[ l_count++ ], GestureType::Click, i, 1U << i, t_time );
+		}
+	}
+
+	return l_count;
+}
+
+// Time in ms to the nearest deadline
+uint32_t GestureNextTimeout( const GestureRecognizer *t_rec, uint32_t t_time )
+{
+	uint32_t l_next = GESTURE_NO_TIMEOUT;
+
+	for ( uint32_t i = 0; i < GESTURE_SWITCHES; i++ )
+	{
+		const SwitchData *l_sw = &t_rec->m_switch[ i ];
+		int32_t l_limit;
+
+		if ( l_sw->m_raw_level != l_sw->m_level )
+		{
+			int32_t l_left = GESTURE_DEBOUNCE_MS - time_diff( t_time, l_sw->m_edge_time );
+			if ( l_left < 0 ) l_left = 0;
+			if ( ( uint32_t ) l_left < l_next ) l_next = l_left;
+		}
+
+		if ( l_sw->m_state == SwitchState::Pressed )
+			l_limit = GESTURE_LONG_PRESS_MS;
+		else if ( l_sw->m_state == SwitchState::WaitSecond )
+			l_limit = GESTURE_DOUBLE_CLICK_MS;
+		else
+			continue;
+
+		int32_t l_left = l_limit - time_diff( t_time, l_sw->m_press_time );
+		if ( l_left < 0 ) l_left = 0;
+		if ( ( uint32_t ) l_left < l_next ) l_next = l_left;
+	}
+
+	return l_next;
+}
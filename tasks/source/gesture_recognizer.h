@@ -0,0 +1,90 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Switch gesture recognizer
+//
+// **************************************************************************
+//
+// Recognizer works only with edges and timestamps in ms. It does not use
+// any RTOS or board API, so recorded edges can be replayed on any computer,
+// see tools/gesture_recognizer_test.cpp.
+//
+// The first edge after quiet switch is accepted at once. Edges closer than
+// GESTURE_DEBOUNCE_MS to the previous accepted edge of the same switch are
+// bounces, only the last raw level is kept. When it differs from accepted
+// level at the end of debounce window, GestureTimeout() accepts it, so the
+// short glitch does not leave switch pressed.
+//
+// Edge may come after deadline, e.g. when task was busy. Expired deadlines
+// are processed before edge, so late second press is not DoubleClick and
+// late release is not Click after LongPress.
+
+#ifndef GESTURE_RECOGNIZER_H
+#define GESTURE_RECOGNIZER_H
+
+#include <stdint.h>
+
+#define GESTURE_SWITCHES			4
+
+#define GESTURE_DEBOUNCE_MS			20
+#define GESTURE_DOUBLE_CLICK_MS		300
+#define GESTURE_LONG_PRESS_MS		800
+#define GESTURE_CHORD_MS			150
+
+// No deadline is pending
+#define GESTURE_NO_TIMEOUT			UINT32_MAX
+
+// Size of output array, expired deadlines of all switches and one edge
+#define GESTURE_OUT_MAX				( GESTURE_SWITCHES + 1 )
+
+enum class GestureType : uint8_t { Click, DoubleClick, LongPress, Chord };
+
+struct Gesture
+{
+	GestureType m_type;
+	uint8_t m_switch;			// index of switch, first pressed switch for Chord
+	uint8_t m_mask;				// mask of all switches in gesture
+	uint32_t m_time;			// time of gesture in ms
+};
+
+enum class SwitchState : uint8_t { Idle, Pressed, WaitSecond, Suppressed };
+
+struct SwitchData
+{
+	SwitchState m_state;
+	bool m_level;				// last accepted level, true = pressed
+	bool m_raw_level;			// level of last edge, may be bounce
+	uint32_t m_edge_time;		// time of last accepted edge
+	uint32_t m_press_time;		// time of first press of gesture
+};
+
+struct GestureRecognizer
+{
+	SwitchData m_switch[ GESTURE_SWITCHES ];
+	uint8_t m_double_click_mask;	// switches waiting for double click
+	uint8_t m_early_click_mask;		// switches with Click before double click timeout
+};
+
+// Reset all switches, only switches in t_double_click_mask recognize DoubleClick,
+// other switches report Click immediately after release. Switches also in
+// t_early_click_mask report Click immediately too, DoubleClick then follows
+// Click of the first press.
+void GestureInit( GestureRecognizer *t_rec, uint8_t t_double_click_mask, uint8_t t_early_click_mask = 0 );
+
+// Process deadlines expired before t_time and one edge of switch,
+// returns number of gestures stored into t_out[ GESTURE_OUT_MAX ].
+int GestureEdge( GestureRecognizer *t_rec, uint32_t t_switch, bool t_pressed, uint32_t t_time, Gesture *t_out );
+
+// Process expired deadlines and debounce windows,
+// returns number of gestures stored into t_out[ GESTURE_SWITCHES ].
+int GestureTimeout( GestureRecognizer *t_rec, uint32_t t_time, Gesture *t_out );
+
+// Time in ms from t_time to the nearest deadline or GESTURE_NO_TIMEOUT.
+uint32_t GestureNextTimeout( const GestureRecognizer *t_rec, uint32_t t_time );
+
+#endif // GESTURE_RECOGNIZER_H
@@ -0,0 +1,126 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Table driven LED animations
+//
+// **************************************************************************
+//
+// FreeRTOS kernel includes.
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+// System includes.
+#include "board.h"
+#include "fsl_debug_console.h"
+#include "led_animation.h"
+#include "static_alloc.h"
+
+#define TASK_NAME_ANIMATION		"animation"
+
+// Animation with number of its generation.
+// Preemption starts new generation, older animations are stopped.
+struct AnimationRequest
+{
+	const Animation *m_anim;
+	uint32_t m_generation;
+};
+
+static GPIO_Type *g_anim_gpio;
+static uint32_t g_anim_pin_mask[ ANIMATION_MAX_LEDS ];
+static uint32_t g_anim_leds;
+static uint32_t g_anim_all_mask;
+
+static QueueHandle_t g_anim_queue;
+static TaskHandle_t g_anim_task;
+static volatile uint32_t g_anim_generation = 0;
+
+// Write whole frame into port
+static void animation_show( uint8_t t_leds )
+{
+	uint32_t l_on = 0;
+
+	for ( uint32_t i = 0; i < g_anim_leds; i++ )
+		if ( t_leds & ( 1U << i ) )
+			l_on |= g_anim_pin_mask[ i ];
+
+	GPIO_PortClear( g_anim_gpio, g_anim_all_mask & ~l_on );
+	GPIO_PortSet( g_anim_gpio, l_on );
+}
+
+void task_animation( void *t_arg )
+{
+	AnimationRequest l_req;
+
+	while ( 1 )
+	{
+		// wait for animation, waiting can be aborted by preemption
+		if ( xQueueReceive( g_anim_queue, &l_req, portMAX_DELAY ) != pdTRUE || !l_req.m_anim )
+			continue;
+
+		TickType_t l_wake = xTaskGetTickCount();
+
+		for ( uint32_t i = 0; i < l_req.m_anim->m_count; i++ )
+		{
+			if ( l_req.m_generation != g_anim_generation ) break;
+
+			const AnimationFrame *l_frame = &l_req.m_anim->m_frames[ i ];
+			animation_show( l_frame->m_leds );
+
+			if ( !l_frame->m_duration_ms ) break;
+
+			vTaskDelayUntil( &l_wake, pdMS_TO_TICKS( l_frame->m_duration_ms ) );
+		}
+	}
+}
+
+// Initialize LEDs and create animation task
+void InitAnimation( GPIO_Type *t_gpio, const uint32_t *t_pin_mask, uint32_t t_leds, UBaseType_t t_priority )
+{
+	configASSERT( t_leds <= ANIMATION_MAX_LEDS );
+
+	g_anim_gpio = t_gpio;
+	g_anim_leds = t_leds;
+	g_anim_all_mask = 0;
+	for ( uint32_t i = 0; i < t_leds; i++ )
+	{
+		g_anim_pin_mask[ i ] = t_pin_mask[ i ];
+		g_anim_all_mask |= t_pin_mask[ i ];
+	}
+
+	g_anim_queue = APP_QUEUE_CREATE( anim, ANIMATION_QUEUE_LEN, sizeof( AnimationRequest ) );
+
+	if ( APP_TASK_CREATE( task_animation, TASK_NAME_ANIMATION, configMINIMAL_STACK_SIZE + 100, NULL, t_priority, &g_anim_task ) != pdPASS )
+	{
+		PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_ANIMATION );
+	}
+}
+
+// Play animation after all queued animations
+bool AnimationQueue( const Animation *t_anim )
+{
+	AnimationRequest l_req = { t_anim, g_anim_generation };
+
+	return xQueueSend( g_anim_queue, &l_req, 0 ) == pdTRUE;
+}
+
+// Stop current animation, drop queued animations and play t_anim immediately (nothing if NULL)
+bool AnimationPreempt( const Animation *t_anim )
+{
+	taskENTER_CRITICAL();
+	AnimationRequest l_req = { t_anim, ++g_anim_generation };
+	taskEXIT_CRITICAL();
+
+	xQueueReset( g_anim_queue );
+	bool l_ret = xQueueSend( g_anim_queue, &l_req, 0 ) == pdTRUE;
+
+	// wake up animation task sleeping in the middle of frame
+	xTaskAbortDelay( g_anim_task );
+
+	return l_ret;
+}
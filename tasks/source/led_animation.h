@@ -0,0 +1,60 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Table driven LED animations
+//
+// **************************************************************************
+//
+// Animation is constant table of frames. Every frame is mask of LEDs and
+// its duration. One animation task plays frames with period given by
+// vTaskDelayUntil, so time error does not accumulate. Frame with zero
+// duration ends animation and its LEDs stay as they are.
+//
+// All LEDs have to be on one GPIO port, every frame is written by one
+// set and one clear of port.
+
+#ifndef LED_ANIMATION_H
+#define LED_ANIMATION_H
+
+#include "FreeRTOS.h"
+#include "fsl_gpio.h"
+
+#define ANIMATION_MAX_LEDS		8
+#define ANIMATION_QUEUE_LEN		4
+
+struct AnimationFrame
+{
+	uint8_t m_leds;				// bit per LED
+	uint16_t m_duration_ms;		// 0 = last frame, hold it
+};
+
+struct Animation
+{
+	const char *m_name;
+	const AnimationFrame *m_frames;
+	uint16_t m_count;
+};
+
+// Define constant animation from array of frames
+#define ANIMATION( t_name, t_frames ) \
+	{ t_name, t_frames, sizeof( t_frames ) / sizeof( AnimationFrame ) }
+
+// Memory used by frames of animation in bytes
+#define ANIMATION_SIZE( t_anim ) ( ( t_anim ).m_count * sizeof( AnimationFrame ) )
+
+// Initialize LEDs t_pin_mask[ t_leds ] on port t_gpio and create animation task
+void InitAnimation( GPIO_Type *t_gpio, const uint32_t *t_pin_mask, uint32_t t_leds, UBaseType_t t_priority );
+
+// Play animation after all queued animations
+bool AnimationQueue( const Animation *t_anim );
+
+// Stop current animation, drop queued animations and play t_anim immediately.
+// NULL only stops animations, LEDs stay as they are.
+bool AnimationPreempt( const Animation *t_anim );
+
+#endif // LED_ANIMATION_H
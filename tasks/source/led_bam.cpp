@@ -0,0 +1,172 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Brightness of LEDs by bit angle modulation
+//
+// **************************************************************************
+//
+// System includes.
+#include "board.h"
+#include "pin_mux.h"
+#include "fsl_pit.h"
+#include "fsl_gpio.h"
+#include "led_bam.h"
+
+#define LED_BAM_PIT_CHNL		kPIT_Chnl_0
+#define LED_BAM_IRQn			PIT0_IRQn
+
+#define LED_BAM_PORTS			3
+
+// pair of GPIO port and LED pin.
+struct LED_Bam
+{
+	uint32_t m_port;		// index into g_bam_gpio
+	uint32_t m_pin;
+};
+
+static GPIO_Type * const g_bam_gpio[ LED_BAM_PORTS ] = { GPIOA, GPIOB, GPIOC };
+
+static const LED_Bam g_bam_led[ LED_BAM_LEDS ] =
+{
+		{ 0, LED_PTA1_PIN }, { 0, LED_PTA2_PIN },
+		{ 2, LED_PTC0_PIN }, { 2, LED_PTC1_PIN }, { 2, LED_PTC2_PIN }, { 2, LED_PTC3_PIN },
+		{ 2, LED_PTC4_PIN }, { 2, LED_PTC5_PIN }, { 2, LED_PTC7_PIN }, { 2, LED_PTC8_PIN },
+		{ 1, LED_PTB2_PIN }, { 1, LED_PTB3_PIN }, { 1, LED_PTB9_PIN }, { 1, LED_PTB10_PIN },
+		{ 1, LED_PTB11_PIN }, { 1, LED_PTB18_PIN }, { 1, LED_PTB19_PIN }, { 1, LED_PTB20_PIN },
+		{ 1, LED_PTB23_PIN },
+};
+
+// Port masks of LEDs which are on in every bit plane
+struct BamFrame
+{
+	uint32_t m_plane[ LED_BAM_BITS ][ LED_BAM_PORTS ];
+};
+
+static BamFrame g_bam_frame[ 2 ];
+static volatile uint32_t g_bam_front = 0;
+static volatile bool g_bam_pending = false;
+
+// State of ISR
+static uint32_t g_bam_shown[ LED_BAM_PORTS ];
+static uint32_t g_bam_plane = 0;
+static uint32_t g_bam_unit;
+static volatile uint32_t g_bam_isr_max = 0;
+
+// Brightness written by task
+static uint8_t g_bam_brightness[ LED_BAM_LEDS ];
+static uint32_t g_bam_led_mask;
+
+extern "C" {
+void PIT0_IRQHandler(void);
+}
+
+// ISR for PIT channel 0, start of bit plane g_bam_plane
+void PIT0_IRQHandler(void)
+{
+	uint32_t l_start = DWT->CYCCNT;
+
+	PIT_ClearStatusFlags( PIT, LED_BAM_PIT_CHNL, kPIT_TimerFlag );
+
+	// new frame only at start of period
+	if ( g_bam_plane == 0 && g_bam_pending )
+	{
+		g_bam_front ^= 1;
+		g_bam_pending = false;
+	}
+
+	const uint32_t *l_plane = g_bam_frame[ g_bam_front ].m_plane[ g_bam_plane ];
+
+	// toggle only changed pins, one store per port
+	for ( uint32_t p = 0; p < LED_BAM_PORTS; p++ )
+	{
+		g_bam_gpio[ p ]->PTOR = l_plane[ p ] ^ g_bam_shown[ p ];
+		g_bam_shown[ p ] = l_plane[ p ];
+	}
+
+	// running period is already loaded, set length of the next one
+	g_bam_plane = ( g_bam_plane + 1 ) % LED_BAM_BITS;
+	PIT_SetTimerPeriod( PIT, LED_BAM_PIT_CHNL, g_bam_unit << g_bam_plane );
+
+	uint32_t l_cycles = DWT->CYCCNT - l_start;
+	if ( l_cycles > g_bam_isr_max )
+		g_bam_isr_max = l_cycles;
+}
+
+// Start BAM for LEDs in t_led_mask
+void LedBamInit( uint32_t t_led_mask )
+{
+	pit_config_t l_config;
+
+	g_bam_led_mask = t_led_mask & LED_BAM_ALL;
+
+	// all used LEDs off, ISR knows state of pins
+	for ( uint32_t i = 0; i < LED_BAM_LEDS; i++ )
+	{
+		g_bam_brightness[ i ] = 0;
+		if ( g_bam_led_mask & ( 1U << i ) )
+			GPIO_PortClear( g_bam_gpio[ g_bam_led[ i ].m_port ], 1U << g_bam_led[ i ].m_pin );
+	}
+	for ( uint32_t p = 0; p < LED_BAM_PORTS; p++ )
+		g_bam_shown[ p ] = 0;
+
+	// cycle counter for ISR duration
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	// one period has ( 2^BITS - 1 ) units
+	g_bam_unit = CLOCK_GetFreq( kCLOCK_BusClk ) / ( LED_BAM_REFRESH_HZ * ( ( 1U << LED_BAM_BITS ) - 1 ) );
+
+	PIT_GetDefaultConfig( &l_config );
+	PIT_Init( PIT, &l_config );
+	PIT_SetTimerPeriod( PIT, LED_BAM_PIT_CHNL, g_bam_unit );
+	PIT_EnableInterrupts( PIT, LED_BAM_PIT_CHNL, kPIT_TimerInterruptEnable );
+
+	// ISR does not use any FreeRTOS API, priority can be above kernel
+	NVIC_SetPriority( LED_BAM_IRQn, 1 );
+	EnableIRQ( LED_BAM_IRQn );
+
+	PIT_StartTimer( PIT, LED_BAM_PIT_CHNL );
+}
+
+// Set brightness of LED in back buffer
+void LedBamSet( uint32_t t_led, uint8_t t_brightness )
+{
+	if ( t_led < LED_BAM_LEDS )
+		g_bam_brightness[ t_led ] = t_brightness;
+}
+
+// Show back buffer from next BAM period
+void LedBamCommit()
+{
+	// ISR must not swap buffers during preparation of back buffer
+	g_bam_pending = false;
+	__DMB();
+
+	BamFrame *l_back = &g_bam_frame[ g_bam_front ^ 1 ];
+
+	for ( uint32_t b = 0; b < LED_BAM_BITS; b++ )
+	{
+		for ( uint32_t p = 0; p < LED_BAM_PORTS; p++ )
+			l_back->m_plane[ b ][ p ] = 0;
+
+		for ( uint32_t i = 0; i < LED_BAM_LEDS; i++ )
+		{
+			if ( ( g_bam_led_mask & ( 1U << i ) ) && ( g_bam_brightness[ i ] & ( 1U << b ) ) )
+				l_back->m_plane[ b ][ g_bam_led[ i ].m_port ] |= 1U << g_bam_led[ i ].m_pin;
+		}
+	}
+
+	__DMB();
+	g_bam_pending = true;
+}
+
+// The longest ISR duration in CPU cycles
+uint32_t LedBamMaxIsrCycles()
+{
+	return g_bam_isr_max;
+}
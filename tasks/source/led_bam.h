@@ -0,0 +1,55 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Brightness of LEDs by bit angle modulation
+//
+// **************************************************************************
+//
+// Bit angle modulation (BAM) shows every bit of 8-bit brightness for time
+// proportional to weight of bit. PIT channel 0 interrupt starts every bit
+// plane. Set and clear masks of all ports are prepared for every plane
+// in advance, ISR only toggles pins which differ from previous plane,
+// it is one PTOR store for each of PTA, PTB and PTC.
+//
+// Frame (brightness of all LEDs) is double buffered. LedBamCommit()
+// prepares back buffer and ISR swaps buffers at start of next period,
+// so there is no lock and no torn frame. Only one task may write frames.
+//
+// LED		Index
+// PTA1..2	0..1
+// PTC0..8	2..9
+// PTB2..23	10..18
+
+#ifndef LED_BAM_H
+#define LED_BAM_H
+
+#include <stdint.h>
+
+#define LED_BAM_LEDS			19
+#define LED_BAM_BITS			8
+#define LED_BAM_REFRESH_HZ		400
+
+#define LED_BAM_INX_PTA			0
+#define LED_BAM_INX_PTC			2
+#define LED_BAM_INX_PTB			10
+
+#define LED_BAM_ALL				( ( 1UL << LED_BAM_LEDS ) - 1 )
+
+// Start BAM for LEDs in t_led_mask (bit per LED index), other LEDs are not touched
+void LedBamInit( uint32_t t_led_mask );
+
+// Set brightness 0..255 of LED in back buffer
+void LedBamSet( uint32_t t_led, uint8_t t_brightness );
+
+// Show back buffer from next BAM period
+void LedBamCommit();
+
+// The longest ISR duration in CPU cycles
+uint32_t LedBamMaxIsrCycles();
+
+#endif // LED_BAM_H
@@ -62,6 +62,13 @@
 #include "MK64F12.h"
 #include "fsl_debug_console.h"
 
+#include "rgb_pwm.h"
+#include "switch_gestures.h"
+#include "led_animation.h"
+#include "command_bus.h"
+#include "led_bam.h"
+#include "static_alloc.h"
+#include "task_monitor.h"
 
 #define LOW_TASK_PRIORITY 		(configMAX_PRIORITIES - 2)
 #define NORMAL_TASK_PRIORITY 	(configMAX_PRIORITIES - 1)
@@ -70,12 +77,8 @@
 
 #define TASK_NAME_SWITCHES			"switches"
 #define TASK_NAME_LED_PTA			"led_pta"
-#define TASK_NAME_LED_SNAKE_L		"led_snake_l"
-#define TASK_NAME_LED_SNAKE_R		"led_snake_r"
-#define TASK_NAME_LED_BOTH_SNAKES	"led_both_snakes"
 #define TASK_NAME_ALL_ON			    "all_on"
 #define TASK_NAME_ALL_OFF			"all_off"
-#define TASK_NAME_RGB_BRIGHTNESS	"rgb_brightness"
 
 
 #define LED_PTA_NUM 	2
@@ -87,25 +90,31 @@
 #define BRIGHTNESS_MAX 10
 #define BRIGHTNESS_MIN 0
 
+#define RGB_BRIGHTNESS1 0
+#define RGB_BRIGHTNESS2 1
 
-#define DOUBLE_CLICK_TIMEOUT_MS   300
-#define DOUBLE_CLICK_TIMEOUT_TICKS pdMS_TO_TICKS(DOUBLE_CLICK_TIMEOUT_MS)
 
-#define DEBOUNCE_DELAY_MS 50
+#define DOUBLE_CLICK_SWITCHES ((1U << SW_INX_PTC9) | (1U << SW_INX_PTC10))
+// click of PTC9 changes brightness at once, as the first click of double click
+#define EARLY_CLICK_SWITCHES (1U << SW_INX_PTC9)
+#define CHORD_SNAKES ((1U << SW_INX_PTC11) | (1U << SW_INX_PTC12))
 
+// command bus endpoints and commands
+#define CMD_EP_ALL_ON       0
+#define CMD_EP_ALL_OFF      1
 
-bool ptc9_prev_state = true;
-bool ptc10_prev_state = true;
-bool ptc12_prev_state = true;
-
-TaskHandle_t l_handle_led_all_on = NULL;
-TaskHandle_t l_handle_led_all_off = NULL;
+#define CMD_LEDS_SET        (1U << 0)
 
 
 volatile uint8_t brightness1 = 5;
 volatile uint8_t brightness2 = 5;
 
-uint32_t site = 0;
+void rgb_brightness_update()
+{
+    RgbPwmSetDuty(RGB_BRIGHTNESS1, brightness1 * RGB_PWM_DUTY_MAX / BRIGHTNESS_MAX);
+    RgbPwmSetDuty(RGB_BRIGHTNESS2, brightness2 * RGB_PWM_DUTY_MAX / BRIGHTNESS_MAX);
+    RgbPwmUpdate();
+}
 
 struct LED_Data
 {
@@ -144,359 +153,165 @@ LED_Data g_led_rgb[LED_PTB_NUM] =
                 {LED_PTB23_PIN, LED_PTB23_GPIO},
         };
 
-void task_led_pta_blink( void *t_arg )
+#define PTA_FADE_STEP       8
+#define PTA_FADE_STEP_MS    20
+
+// Cross fade of PTA LEDs by BAM, brightness of one LED goes up and of the other down
+void task_led_pta_fade( void *t_arg )
 {
-    uint32_t l_inx = 0;
+    TickType_t l_wake = xTaskGetTickCount();
+    uint32_t l_isr_max = 0;
+    int32_t l_level = 0;
+    int32_t l_step = PTA_FADE_STEP;
 
     while ( 1 )
     {
-        GPIO_PinWrite( g_led_pta[ l_inx ].m_led_gpio, g_led_pta[ l_inx ].m_led_pin, 1 );
-        vTaskDelay( pdMS_TO_TICKS(200) );
-
-        GPIO_PinWrite( g_led_pta[ l_inx ].m_led_gpio, g_led_pta[ l_inx ].m_led_pin, 0 );
+        LedBamSet( LED_BAM_INX_PTA, l_level );
+        LedBamSet( LED_BAM_INX_PTA + 1, 255 - l_level );
+        LedBamCommit();
 
-        l_inx++;
-        l_inx %= LED_PTA_NUM;
-    }
-}
-
-void task_all_on(void *t_arg){
-    while (1)
-    {
-        for (int inx = 0; inx < LED_PTC_NUM; inx++)
+        l_level += l_step;
+        if ( l_level > 255 || l_level < 0 )
         {
-            GPIO_PinWrite(g_led_ptc[inx].m_led_gpio, g_led_ptc[inx].m_led_pin, 1);
+            l_step = -l_step;
+            l_level += 2 * l_step;
         }
 
-        vTaskSuspend(NULL);
-    }
-}
-
-void task_all_off(void *t_arg){
-    while (1)
-    {
-        for (int inx = 0; inx < LED_PTC_NUM; inx++)
+        if ( LedBamMaxIsrCycles() > l_isr_max )
         {
-            GPIO_PinWrite(g_led_ptc[inx].m_led_gpio, g_led_ptc[inx].m_led_pin, 0);
+            l_isr_max = LedBamMaxIsrCycles();
+            PRINTF( "BAM ISR worst case %u cycles.\r\n", l_isr_max );
         }
 
-        vTaskSuspend(NULL);
+        vTaskDelayUntil( &l_wake, pdMS_TO_TICKS( PTA_FADE_STEP_MS ) );
     }
 }
 
-void task_snake_left( void *t_arg )
-{
-    while ( 1 )
+void task_all_on(void *t_arg){
+    while (1)
     {
-        vTaskSuspend( NULL );
-        if(site == 0){
-            for ( int inx = 0; inx < LED_PTC_NUM; inx++ )
+        if (CommandBusWait(portMAX_DELAY) & CMD_LEDS_SET)
+        {
+            for (int inx = 0; inx < LED_PTC_NUM; inx++)
             {
-                GPIO_PinWrite( g_led_ptc[ inx ].m_led_gpio, g_led_ptc[ inx ].m_led_pin, 1 );
-                if (inx > 0)
-                {
-                    GPIO_PinWrite( g_led_ptc[ inx - 1 ].m_led_gpio, g_led_ptc[ inx - 1].m_led_pin, 1 );
-                }
-                vTaskDelay( pdMS_TO_TICKS(200) );
-                GPIO_PinWrite( g_led_ptc[ inx ].m_led_gpio, g_led_ptc[ inx ].m_led_pin, 0 );
-                if (inx > 0)
-                {
-                    GPIO_PinWrite( g_led_ptc[ inx - 1].m_led_gpio, g_led_ptc[ inx - 1 ].m_led_pin, 0 );
-                }
+                GPIO_PinWrite(g_led_ptc[inx].m_led_gpio, g_led_ptc[inx].m_led_pin, 1);
             }
-            GPIO_PinWrite( g_led_ptc[7].m_led_gpio, g_led_ptc[7].m_led_pin, 1);
         }
-        site = 7;
     }
 }
 
-void task_snake_right( void *t_arg )
-{
-    while ( 1 )
+void task_all_off(void *t_arg){
+    while (1)
     {
-        vTaskSuspend( NULL );
-        if(site == 7){
-            for ( int inx = LED_PTC_NUM - 1; inx >= 0; inx-- )
+        if (CommandBusWait(portMAX_DELAY) & CMD_LEDS_SET)
+        {
+            for (int inx = 0; inx < LED_PTC_NUM; inx++)
             {
-                GPIO_PinWrite( g_led_ptc[ inx ].m_led_gpio, g_led_ptc[ inx ].m_led_pin, 1 );
-                if (inx > 0)
-                {
-                    GPIO_PinWrite( g_led_ptc[ inx -1].m_led_gpio, g_led_ptc[ inx-1].m_led_pin, 1 );
-                }
-                vTaskDelay( pdMS_TO_TICKS(200) );
-                GPIO_PinWrite( g_led_ptc[ inx ].m_led_gpio, g_led_ptc[ inx ].m_led_pin, 0 );
-                if (inx > 0)
-                {
-                    GPIO_PinWrite( g_led_ptc[ inx-1].m_led_gpio, g_led_ptc[ inx-1 ].m_led_pin, 0 );
-                }
+                GPIO_PinWrite(g_led_ptc[inx].m_led_gpio, g_led_ptc[inx].m_led_pin, 0);
             }
-            GPIO_PinWrite( g_led_ptc[0].m_led_gpio, g_led_ptc[0].m_led_pin, 1);
         }
-        site = 0;
     }
 }
 
-void task_both_snakes(void *t_arg){
-    while(1){
-        vTaskSuspend( NULL );
+#define SNAKE_STEP_MS 200
 
-        if(site == 0){
-            for ( int inx = 0; inx < LED_PTC_NUM; inx++ )
-            {
-                GPIO_PinWrite( g_led_ptc[ inx ].m_led_gpio, g_led_ptc[ inx ].m_led_pin, 1 );
-                if (inx > 0)
-                {
-                    GPIO_PinWrite( g_led_ptc[ inx - 1 ].m_led_gpio, g_led_ptc[ inx - 1].m_led_pin, 1 );
-                }
-                vTaskDelay( pdMS_TO_TICKS(200) );
-                GPIO_PinWrite( g_led_ptc[ inx ].m_led_gpio, g_led_ptc[ inx ].m_led_pin, 0 );
-                if (inx > 0)
-                {
-                    GPIO_PinWrite( g_led_ptc[ inx - 1].m_led_gpio, g_led_ptc[ inx - 1 ].m_led_pin, 0 );
-                }
-            }
-            GPIO_PinWrite( g_led_ptc[7].m_led_gpio, g_led_ptc[7].m_led_pin, 1);
+// Snake from PTC0 to PTC8, last LED stays on
+const AnimationFrame g_snake_left_frames[] =
+        {
+                { 0x01, SNAKE_STEP_MS }, { 0x03, SNAKE_STEP_MS }, { 0x06, SNAKE_STEP_MS }, { 0x0C, SNAKE_STEP_MS },
+                { 0x18, SNAKE_STEP_MS }, { 0x30, SNAKE_STEP_MS }, { 0x60, SNAKE_STEP_MS }, { 0xC0, SNAKE_STEP_MS },
+                { 0x80, 0 },
+        };
 
-            for ( int inx = LED_PTC_NUM - 1; inx >= 0; inx-- )
-            {
-                GPIO_PinWrite( g_led_ptc[ inx ].m_led_gpio, g_led_ptc[ inx ].m_led_pin, 1 );
-                if (inx > 0)
-                {
-                    GPIO_PinWrite( g_led_ptc[ inx -1].m_led_gpio, g_led_ptc[ inx-1].m_led_pin, 1 );
-                }
-                vTaskDelay( pdMS_TO_TICKS(200) );
-                GPIO_PinWrite( g_led_ptc[ inx ].m_led_gpio, g_led_ptc[ inx ].m_led_pin, 0 );
-                if (inx > 0)
-                {
-                    GPIO_PinWrite( g_led_ptc[ inx-1].m_led_gpio, g_led_ptc[ inx-1 ].m_led_pin, 0 );
-                }
-            }
-            GPIO_PinWrite( g_led_ptc[0].m_led_gpio, g_led_ptc[0].m_led_pin, 1);
-            site = 0;
-        } else if(site == 7){
-            for ( int inx = LED_PTC_NUM - 1; inx >= 0; inx-- )
-            {
-                GPIO_PinWrite( g_led_ptc[ inx ].m_led_gpio, g_led_ptc[ inx ].m_led_pin, 1 );
-                if (inx > 0)
-                {
-                    GPIO_PinWrite( g_led_ptc[ inx -1].m_led_gpio, g_led_ptc[ inx-1].m_led_pin, 1 );
-                }
-                vTaskDelay( pdMS_TO_TICKS(200) );
-                GPIO_PinWrite( g_led_ptc[ inx ].m_led_gpio, g_led_ptc[ inx ].m_led_pin, 0 );
-                if (inx > 0)
-                {
-                    GPIO_PinWrite( g_led_ptc[ inx-1].m_led_gpio, g_led_ptc[ inx-1 ].m_led_pin, 0 );
-                }
-            }
-            for ( int inx = 0; inx < LED_PTC_NUM; inx++ )
-            {
-                GPIO_PinWrite( g_led_ptc[ inx ].m_led_gpio, g_led_ptc[ inx ].m_led_pin, 1 );
-                if (inx > 0)
-                {
-                    GPIO_PinWrite( g_led_ptc[ inx - 1 ].m_led_gpio, g_led_ptc[ inx - 1].m_led_pin, 1 );
-                }
-                vTaskDelay( pdMS_TO_TICKS(200) );
-                GPIO_PinWrite( g_led_ptc[ inx ].m_led_gpio, g_led_ptc[ inx ].m_led_pin, 0 );
-                if (inx > 0)
-                {
-                    GPIO_PinWrite( g_led_ptc[ inx - 1].m_led_gpio, g_led_ptc[ inx - 1 ].m_led_pin, 0 );
-                }
-            }
-            GPIO_PinWrite( g_led_ptc[7].m_led_gpio, g_led_ptc[7].m_led_pin, 1);
-            site = 7;
-        }
-    }
-}
+// Snake from PTC8 to PTC0, first LED stays on
+const AnimationFrame g_snake_right_frames[] =
+        {
+                { 0xC0, SNAKE_STEP_MS }, { 0x60, SNAKE_STEP_MS }, { 0x30, SNAKE_STEP_MS }, { 0x18, SNAKE_STEP_MS },
+                { 0x0C, SNAKE_STEP_MS }, { 0x06, SNAKE_STEP_MS }, { 0x03, SNAKE_STEP_MS }, { 0x01, SNAKE_STEP_MS },
+                { 0x01, 0 },
+        };
+
+const Animation g_snake_left = ANIMATION( "snake left", g_snake_left_frames );
+const Animation g_snake_right = ANIMATION( "snake right", g_snake_right_frames );
 
 void task_switches( void *t_arg )
 {
-    TaskHandle_t l_handle_led_snake_l = xTaskGetHandle( TASK_NAME_LED_SNAKE_L );
-    TaskHandle_t l_handle_led_snake_r = xTaskGetHandle( TASK_NAME_LED_SNAKE_R );
-    TaskHandle_t l_handle_led_both_snakes = xTaskGetHandle( TASK_NAME_LED_BOTH_SNAKES );
-    TaskHandle_t l_handle_led_all_on = xTaskGetHandle( TASK_NAME_ALL_ON );
-    TaskHandle_t l_handle_led_all_off= xTaskGetHandle( TASK_NAME_ALL_OFF );
-
-    TickType_t last_ptc9_click_time = 0;
-    uint8_t ptc9_click_count = 0;
-    TickType_t last_ptc10_click_time = 0;
-    uint8_t ptc10_click_count = 0;
+    // snake is on the left (0) or right (7) side
+    uint32_t l_site = 0;
+    Gesture l_gesture;
 
     while ( 1 )
     {
+        xQueueReceive( g_gesture_queue, &l_gesture, portMAX_DELAY );
 
-        bool ptc9_current_state = (GPIO_PinRead(SW_PTC9_GPIO, SW_PTC9_PIN) == 0);
-        if (ptc9_current_state && !ptc9_prev_state)
+        switch ( l_gesture.m_type )
         {
-            TickType_t current_time = xTaskGetTickCount();
-            if (ptc9_click_count == 0)
-            {
-
-                ptc9_click_count = 1;
-                last_ptc9_click_time = current_time;
-            }
-            else if (ptc9_click_count == 1)
+        case GestureType::Click:
+            if (l_gesture.m_switch == SW_INX_PTC9)
             {
-
-                if ((current_time - last_ptc9_click_time) <= DOUBLE_CLICK_TIMEOUT_TICKS)
-                {
-
-                    ptc9_click_count = 0;
-
-                    if (l_handle_led_all_on)
-                    {
-                        vTaskResume(l_handle_led_all_on);
-                    }
-                }
-                else
+                if (brightness1 >= BRIGHTNESS_STEP && brightness2 <= (BRIGHTNESS_MAX - BRIGHTNESS_STEP))
                 {
-
-                    ptc9_click_count = 1;
-                    last_ptc9_click_time = current_time;
+                    brightness1 -= BRIGHTNESS_STEP;
+                    brightness2 += BRIGHTNESS_STEP;
+                    rgb_brightness_update();
                 }
             }
-
-
-            if (ptc9_click_count == 1)
+            else if (l_gesture.m_switch == SW_INX_PTC11)
             {
+                if ( l_site == 0 && AnimationQueue( &g_snake_left ) )
+                    l_site = 7;
+            }
+            else if (l_gesture.m_switch == SW_INX_PTC12)
+            {
+                if ( l_site == 7 && AnimationQueue( &g_snake_right ) )
+                    l_site = 0;
 
-                vTaskDelay(pdMS_TO_TICKS(DEBOUNCE_DELAY_MS));
-
-                if (GPIO_PinRead(SW_PTC9_GPIO, SW_PTC9_PIN) == 0)
+                if (brightness2 >= BRIGHTNESS_STEP && brightness1 <= (BRIGHTNESS_MAX - BRIGHTNESS_STEP))
                 {
-
-                    if (brightness1 >= BRIGHTNESS_STEP && brightness2 <= (BRIGHTNESS_MAX - BRIGHTNESS_STEP))
-                    {
-                        brightness1 -= BRIGHTNESS_STEP;
-                        brightness2 += BRIGHTNESS_STEP;
-                    }
+                    brightness2 -= BRIGHTNESS_STEP;
+                    brightness1 += BRIGHTNESS_STEP;
+                    rgb_brightness_update();
                 }
             }
-        }
-        ptc9_prev_state = ptc9_current_state;
+            break;
 
-
-        bool ptc10_current_state = (GPIO_PinRead(SW_PTC10_GPIO, SW_PTC10_PIN) == 0);
-        if (ptc10_current_state && !ptc10_prev_state)
-        {
-            TickType_t current_time = xTaskGetTickCount();
-            if (ptc10_click_count == 0)
+        case GestureType::DoubleClick:
+            if (l_gesture.m_switch == SW_INX_PTC9)
             {
-
-                ptc10_click_count = 1;
-                last_ptc10_click_time = current_time;
+                AnimationPreempt(NULL);
+                CommandBusSend(CMD_EP_ALL_ON, CMD_LEDS_SET);
             }
-            else if (ptc10_click_count == 1)
+            else if (l_gesture.m_switch == SW_INX_PTC10)
             {
-
-                if ((current_time - last_ptc10_click_time) <= DOUBLE_CLICK_TIMEOUT_TICKS)
-                {
-
-                    ptc10_click_count = 0;
-
-                    if (l_handle_led_all_off)
-                    {
-                        vTaskResume(l_handle_led_all_off);
-                    }
-                }
-                else
-                {
-
-                    ptc10_click_count = 1;
-                    last_ptc10_click_time = current_time;
-                }
+                AnimationPreempt(NULL);
+                CommandBusSend(CMD_EP_ALL_OFF, CMD_LEDS_SET);
             }
-        }
-        ptc10_prev_state = ptc10_current_state;
-
-
-        bool ptc12_current_state = (GPIO_PinRead(SW_PTC12_GPIO, SW_PTC12_PIN) == 0);
-        if (ptc12_current_state && !ptc12_prev_state)
-        {
+            break;
 
-            if ( l_handle_led_snake_r )
-                vTaskResume( l_handle_led_snake_r );
-
-            vTaskDelay(pdMS_TO_TICKS(DEBOUNCE_DELAY_MS));
-
-            if (GPIO_PinRead(SW_PTC12_GPIO, SW_PTC12_PIN) == 0)
+        case GestureType::Chord:
+            if ((l_gesture.m_mask & CHORD_SNAKES) == CHORD_SNAKES)
             {
-
-                if (brightness2 >= BRIGHTNESS_STEP && brightness1 <= (BRIGHTNESS_MAX - BRIGHTNESS_STEP))
-                {
-                    brightness2 -= BRIGHTNESS_STEP;
-                    brightness1 += BRIGHTNESS_STEP;
-                }
+                // there and back again, site does not change
+                AnimationQueue( l_site == 0 ? &g_snake_left : &g_snake_right );
+                AnimationQueue( l_site == 0 ? &g_snake_right : &g_snake_left );
             }
-        }
-        ptc12_prev_state = ptc12_current_state;
-
+            break;
 
-        if ( GPIO_PinRead( SW_PTC11_GPIO, SW_PTC11_PIN ) == 0 )
-        {
-            if ( l_handle_led_snake_l )
-                vTaskResume( l_handle_led_snake_l );
-        }
-
-
-        if(GPIO_PinRead( SW_PTC11_GPIO, SW_PTC11_PIN ) == 0 && GPIO_PinRead( SW_PTC12_GPIO, SW_PTC12_PIN ) == 0)
-        {
-            if (l_handle_led_both_snakes)
-                vTaskResume(l_handle_led_both_snakes);
-        }
-
-        vTaskDelay( pdMS_TO_TICKS(10) );
-    }
-}
-void task_rgb_brightness_control(void *t_arg)
-{
-    uint8_t counter = 0;
-
-    while(1)
-    {
-
-        counter++;
-        if(counter >= BRIGHTNESS_MAX)
-        {
-            counter = 0;
-        }
-
-
-        if(counter < brightness1)
-        {
-            GPIO_PinWrite(LED_PTB2_GPIO, LED_PTB2_PIN, 1);
-            GPIO_PinWrite(LED_PTB3_GPIO, LED_PTB3_PIN, 1);
-            GPIO_PinWrite(LED_PTB9_GPIO, LED_PTB9_PIN, 1);
-        }
-        else
-        {
-            GPIO_PinWrite(LED_PTB2_GPIO, LED_PTB2_PIN, 0);
-            GPIO_PinWrite(LED_PTB3_GPIO, LED_PTB3_PIN, 0);
-            GPIO_PinWrite(LED_PTB9_GPIO, LED_PTB9_PIN, 0);
-        }
-
-
-        if(counter < brightness2)
-        {
-            GPIO_PinWrite(LED_PTB19_GPIO, LED_PTB19_PIN, 1);
-            GPIO_PinWrite(LED_PTB20_GPIO, LED_PTB20_PIN, 1);
-            GPIO_PinWrite(LED_PTB23_GPIO, LED_PTB23_PIN, 1);
-        }
-        else
-        {
-            GPIO_PinWrite(LED_PTB10_GPIO, LED_PTB10_PIN, 0);
-            GPIO_PinWrite(LED_PTB11_GPIO, LED_PTB11_PIN, 0);
-            GPIO_PinWrite(LED_PTB18_GPIO, LED_PTB18_PIN, 0);
+        case GestureType::LongPress:
+            if (l_gesture.m_switch == SW_INX_PTC10)
+            {
+                brightness1 = BRIGHTNESS_MAX / 2;
+                brightness2 = BRIGHTNESS_MAX / 2;
+                rgb_brightness_update();
+            }
+            break;
         }
-
-
-        vTaskDelay(pdMS_TO_TICKS(1));
     }
 }
 
 
 
 
-
 int main(void) {
 
 
@@ -511,14 +326,33 @@ int main(void) {
     PRINTF( "Pressing PTC12 decreases RGB1 brightness by 10%% and increases RGB0 by 10%%.\r\n" );
     PRINTF( "Double-clicking PTC9 turns all LEDs on.\r\n" );
     PRINTF( "Double-clicking PTC10 turns all LEDs off.\r\n" );
+    PRINTF( "Pressing PTC11 and PTC12 together runs both snakes.\r\n" );
+    PRINTF( "PTA LEDs fade one into another.\r\n" );
+    PRINTF( "Holding PTC10 sets both RGB LEDs back to 50%% brightness.\r\n" );
     PRINTF( "Other buttons control LED animations as before.\r\n" );
 
 
     brightness1 = 5;
     brightness2 = 5;
 
-    if ( xTaskCreate(
-            task_led_pta_blink,
+    RgbPwmInit();
+    rgb_brightness_update();
+
+    // PTB LEDs are driven by FTM0 and PTC LEDs by animations
+    LedBamInit( ( 1U << LED_BAM_INX_PTA ) | ( 1U << ( LED_BAM_INX_PTA + 1 ) ) );
+
+    InitSwitchGestures( DOUBLE_CLICK_SWITCHES, EARLY_CLICK_SWITCHES, NORMAL_TASK_PRIORITY );
+
+    uint32_t l_ptc_masks[ LED_PTC_NUM ];
+    for ( int inx = 0; inx < LED_PTC_NUM; inx++ )
+        l_ptc_masks[ inx ] = 1U << g_led_ptc[ inx ].m_led_pin;
+    InitAnimation( GPIOC, l_ptc_masks, LED_PTC_NUM, NORMAL_TASK_PRIORITY );
+
+    PRINTF( "Animation '%s' uses %d bytes.\r\n", g_snake_left.m_name, ANIMATION_SIZE( g_snake_left ) );
+    PRINTF( "Animation '%s' uses %d bytes.\r\n", g_snake_right.m_name, ANIMATION_SIZE( g_snake_right ) );
+
+    if ( APP_TASK_CREATE(
+            task_led_pta_fade,
             TASK_NAME_LED_PTA,
             configMINIMAL_STACK_SIZE + 100,
             NULL,
@@ -528,47 +362,33 @@ int main(void) {
         PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_LED_PTA );
     }
 
-    if ( xTaskCreate( task_snake_left, TASK_NAME_LED_SNAKE_L, configMINIMAL_STACK_SIZE + 100, NULL, NORMAL_TASK_PRIORITY, NULL ) != pdPASS )
-    {
-        PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_LED_SNAKE_L );
-    }
-
-    if ( xTaskCreate( task_snake_right, TASK_NAME_LED_SNAKE_R, configMINIMAL_STACK_SIZE + 100, NULL, NORMAL_TASK_PRIORITY, NULL ) != pdPASS)
-    {
-        PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_LED_SNAKE_R );
-    }
-
-    if ( xTaskCreate( task_switches, TASK_NAME_SWITCHES, configMINIMAL_STACK_SIZE + 100, NULL, NORMAL_TASK_PRIORITY, NULL) != pdPASS )
+    if ( APP_TASK_CREATE( task_switches, TASK_NAME_SWITCHES, configMINIMAL_STACK_SIZE + 100, NULL, NORMAL_TASK_PRIORITY, NULL) != pdPASS )
     {
         PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_SWITCHES );
     }
 
-    if ( xTaskCreate( task_both_snakes, TASK_NAME_LED_BOTH_SNAKES, configMINIMAL_STACK_SIZE + 100, NULL, NORMAL_TASK_PRIORITY, NULL) != pdPASS )
-    {
-        PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_LED_BOTH_SNAKES );
-    }
+    TaskHandle_t l_handle;
 
-    if ( xTaskCreate( task_all_on, TASK_NAME_ALL_ON, configMINIMAL_STACK_SIZE + 100, NULL, NORMAL_TASK_PRIORITY, NULL) != pdPASS )
+    if ( APP_TASK_CREATE( task_all_on, TASK_NAME_ALL_ON, configMINIMAL_STACK_SIZE + 100, NULL, NORMAL_TASK_PRIORITY, &l_handle) != pdPASS )
     {
         PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_ALL_ON );
     }
+    else
+        CommandBusRegister( CMD_EP_ALL_ON, l_handle );
 
-    if ( xTaskCreate( task_all_off, TASK_NAME_ALL_OFF, configMINIMAL_STACK_SIZE + 100, NULL, NORMAL_TASK_PRIORITY, NULL) != pdPASS )
+    if ( APP_TASK_CREATE( task_all_off, TASK_NAME_ALL_OFF, configMINIMAL_STACK_SIZE + 100, NULL, NORMAL_TASK_PRIORITY, &l_handle) != pdPASS )
     {
         PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_ALL_OFF );
     }
+    else
+        CommandBusRegister( CMD_EP_ALL_OFF, l_handle );
 
+#if COMMAND_BUS_BENCHMARK
+    CommandBusBenchmark( LOW_TASK_PRIORITY );
+#endif
+
+    TaskMonitorInit( TASK_MONITOR_PERIOD_MS, tskIDLE_PRIORITY + 1 );
 
-    if ( xTaskCreate(
-            task_rgb_brightness_control,
-            TASK_NAME_RGB_BRIGHTNESS,
-            configMINIMAL_STACK_SIZE + 200,
-            NULL,
-            NORMAL_TASK_PRIORITY,
-            NULL ) != pdPASS )
-    {
-        PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_RGB_BRIGHTNESS );
-    }
 
     vTaskStartScheduler();
 
@@ -0,0 +1,157 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         RGB LEDs brightness control by FTM timer
+//
+// **************************************************************************
+//
+// System includes.
+#include "board.h"
+#include "pin_mux.h"
+#include "fsl_ftm.h"
+#include "fsl_gpio.h"
+#include "rgb_pwm.h"
+
+#define RGB_PWM_FTM				FTM0
+#define RGB_PWM_FTM_IRQn		FTM0_IRQn
+
+// GPIOB pins of every RGB LED
+static const uint32_t g_rgb_pwm_mask[ RGB_PWM_CHANNELS ] =
+{
+		LED_PTB2_GPIO_PIN_MASK | LED_PTB3_GPIO_PIN_MASK | LED_PTB9_GPIO_PIN_MASK,
+		LED_PTB10_GPIO_PIN_MASK | LED_PTB11_GPIO_PIN_MASK | LED_PTB18_GPIO_PIN_MASK,
+		LED_PTB19_GPIO_PIN_MASK | LED_PTB20_GPIO_PIN_MASK | LED_PTB23_GPIO_PIN_MASK,
+};
+
+// Buffered duty cycles and LEDs switched on at the start of period
+static uint32_t g_rgb_pwm_duty[ RGB_PWM_CHANNELS ];
+static uint32_t g_rgb_pwm_on_mask = 0;
+
+// Reading CnV returns written value before FTM loads it at the end of period,
+// so ISR compares counter with its own copy of loaded channel values
+static uint32_t g_rgb_pwm_cnv[ RGB_PWM_CHANNELS ];
+static uint32_t g_rgb_pwm_next_cnv[ RGB_PWM_CHANNELS ];
+static uint32_t g_rgb_pwm_next_on_mask = 0;
+static volatile bool g_rgb_pwm_reload = false;
+
+extern "C" {
+void FTM0_IRQHandler(void);
+}
+
+// ISR for FTM0
+void FTM0_IRQHandler(void)
+{
+	uint32_t l_flags = FTM_GetStatusFlags( RGB_PWM_FTM );
+	FTM_ClearStatusFlags( RGB_PWM_FTM, l_flags );
+
+	// New period, switch on all LEDs with non zero duty
+	if ( l_flags & kFTM_TimeOverflowFlag )
+	{
+		// FTM has just loaded values of RgbPwmUpdate()
+		if ( g_rgb_pwm_reload )
+		{
+			uint32_t l_all_mask = 0;
+			for ( uint32_t l_ch = 0; l_ch < RGB_PWM_CHANNELS; l_ch++ )
+			{
+				g_rgb_pwm_cnv[ l_ch ] = g_rgb_pwm_next_cnv[ l_ch ];
+				l_all_mask |= g_rgb_pwm_mask[ l_ch ];
+			}
+			g_rgb_pwm_on_mask = g_rgb_pwm_next_on_mask;
+			g_rgb_pwm_reload = false;
+
+			// LEDs without duty are not switched off by any match
+			GPIO_PortClear( GPIOB, l_all_mask & ~g_rgb_pwm_on_mask );
+		}
+		GPIO_PortSet( GPIOB, g_rgb_pwm_on_mask );
+	}
+
+	uint32_t l_cnt = RGB_PWM_FTM->CNT;
+
+	for ( uint32_t l_ch = 0; l_ch < RGB_PWM_CHANNELS; l_ch++ )
+	{
+		// Late match from previous period is ignored, LED was just switched on again
+		if ( ( l_flags & ( 1U << l_ch ) ) && l_cnt >= g_rgb_pwm_cnv[ l_ch ] )
+			GPIO_PortClear( GPIOB, g_rgb_pwm_mask[ l_ch ] );
+	}
+}
+
+// Initialize FTM0 and start PWM with all LEDs off
+void RgbPwmInit()
+{
+	ftm_config_t l_config;
+	ftm_chnl_pwm_signal_param_t l_params[ RGB_PWM_CHANNELS ];
+	uint32_t l_src_clock = CLOCK_GetFreq( kCLOCK_BusClk );
+
+	FTM_GetDefaultConfig( &l_config );
+	l_config.prescale = FTM_CalculateCounterClkDiv( RGB_PWM_FTM, RGB_PWM_FREQ_HZ, l_src_clock );
+	// Buffered channel values are loaded at the end of period after software trigger
+	l_config.reloadPoints = kFTM_CntMax;
+	FTM_Init( RGB_PWM_FTM, &l_config );
+
+	for ( uint32_t l_ch = 0; l_ch < RGB_PWM_CHANNELS; l_ch++ )
+	{
+		l_params[ l_ch ].chnlNumber = ( ftm_chnl_t ) l_ch;
+		l_params[ l_ch ].level = kFTM_HighTrue;
+		l_params[ l_ch ].dutyCyclePercent = 0;
+		l_params[ l_ch ].firstEdgeDelayPercent = 0;
+		l_params[ l_ch ].enableComplementary = false;
+		l_params[ l_ch ].enableDeadtime = false;
+
+		g_rgb_pwm_duty[ l_ch ] = 0;
+		g_rgb_pwm_cnv[ l_ch ] = 0;
+		GPIO_PortClear( GPIOB, g_rgb_pwm_mask[ l_ch ] );
+	}
+
+	FTM_SetupPwm( RGB_PWM_FTM, l_params, RGB_PWM_CHANNELS, kFTM_EdgeAlignedPwm, RGB_PWM_FREQ_HZ, l_src_clock );
+
+	FTM_EnableInterrupts( RGB_PWM_FTM, kFTM_TimeOverflowInterruptEnable | ( ( 1U << RGB_PWM_CHANNELS ) - 1 ) );
+
+	// ISR does not use any FreeRTOS API, priority can be above kernel
+	NVIC_SetPriority( RGB_PWM_FTM_IRQn, 1 );
+	EnableIRQ( RGB_PWM_FTM_IRQn );
+
+	FTM_StartTimer( RGB_PWM_FTM, kFTM_SystemClock );
+}
+
+// Set duty cycle of one RGB LED, new value is buffered until RgbPwmUpdate()
+void RgbPwmSetDuty( uint32_t t_channel, uint32_t t_duty )
+{
+	if ( t_channel >= RGB_PWM_CHANNELS )
+		return;
+
+	if ( t_duty > RGB_PWM_DUTY_MAX )
+		t_duty = RGB_PWM_DUTY_MAX;
+
+	g_rgb_pwm_duty[ t_channel ] = t_duty;
+}
+
+// Apply all buffered duty cycles together at the end of the current period
+void RgbPwmUpdate()
+{
+	uint32_t l_mod = RGB_PWM_FTM->MOD;
+	uint32_t l_on_mask = 0;
+
+	// ISR must not take half of new values
+	DisableIRQ( RGB_PWM_FTM_IRQn );
+
+	for ( uint32_t l_ch = 0; l_ch < RGB_PWM_CHANNELS; l_ch++ )
+	{
+		g_rgb_pwm_next_cnv[ l_ch ] = RgbPwmDutyToCnV( l_mod, g_rgb_pwm_duty[ l_ch ] );
+		RGB_PWM_FTM->CONTROLS[ l_ch ].CnV = g_rgb_pwm_next_cnv[ l_ch ];
+
+		if ( g_rgb_pwm_duty[ l_ch ] )
+			l_on_mask |= g_rgb_pwm_mask[ l_ch ];
+	}
+	g_rgb_pwm_next_on_mask = l_on_mask;
+	g_rgb_pwm_reload = true;
+
+	// All channels are reloaded at once, LED switching follows in ISR
+	FTM_SetSoftwareTrigger( RGB_PWM_FTM, true );
+
+	EnableIRQ( RGB_PWM_FTM_IRQn );
+}
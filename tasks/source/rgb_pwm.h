@@ -0,0 +1,59 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         RGB LEDs brightness control by FTM timer
+//
+// **************************************************************************
+//
+// RGB LEDs on PTBx pins are not routed to FTM channel outputs, so FTM0 is
+// used only as PWM time base. Overflow interrupt switches LEDs on, channel
+// match interrupt switches them off. No task is needed for PWM at all.
+//
+// Channel	LEDs
+// 0		RGB0: PTB2, PTB3, PTB9
+// 1		RGB1: PTB10, PTB11, PTB18
+// 2		RGB2: PTB19, PTB20, PTB23
+//
+// tools/rgb_pwm_test.cpp builds this module on host against FTM register
+// mock in tools/ftm_mock and checks duty cycles and update ordering.
+
+#ifndef RGB_PWM_H
+#define RGB_PWM_H
+
+#include <stdint.h>
+
+// Number of RGB LEDs (FTM channels)
+#define RGB_PWM_CHANNELS		3
+
+// PWM carrier frequency, must be above flicker limit
+#define RGB_PWM_FREQ_HZ			2000
+
+// Duty cycle resolution in bits, 8..16
+#define RGB_PWM_DUTY_BITS		16
+#define RGB_PWM_DUTY_MAX		( ( 1UL << RGB_PWM_DUTY_BITS ) - 1 )
+
+// Convert duty cycle 0..RGB_PWM_DUTY_MAX to FTM channel value for period t_mod + 1.
+// Full duty gives value above MOD, so channel match never occurs and LED stays on.
+static inline uint32_t RgbPwmDutyToCnV( uint32_t t_mod, uint32_t t_duty )
+{
+	if ( t_duty >= RGB_PWM_DUTY_MAX )
+		return t_mod + 1;
+
+	return ( ( t_mod + 1 ) * t_duty ) >> RGB_PWM_DUTY_BITS;
+}
+
+// Initialize FTM0 and start PWM with all LEDs off
+void RgbPwmInit();
+
+// Set duty cycle of one RGB LED, new value is buffered until RgbPwmUpdate()
+void RgbPwmSetDuty( uint32_t t_channel, uint32_t t_duty );
+
+// Apply all buffered duty cycles together at the end of the current period
+void RgbPwmUpdate();
+
+#endif // RGB_PWM_H
@@ -0,0 +1,105 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Tasks and kernel objects with static or dynamic memory
+//
+// **************************************************************************
+//
+// APP_STATIC_ALLOCATION in FreeRTOSConfig.h selects how application creates
+// tasks, queues and semaphores:
+//
+// 0 - xTaskCreate(), xQueueCreate() ... allocate from configTOTAL_HEAP_SIZE.
+// 1 - stack, TCB and queue storage are static objects reserved by linker,
+//     xTaskCreateStatic(), xQueueCreateStatic() ... only initialize them.
+//     Missing RAM is reported by linker, not by "Unable to create task".
+//
+// Every macro below declares its own static objects, so one macro call
+// may create only one task or object at a time. Task created repeatedly
+// while the previous one is still running must use xTaskCreate().
+//
+// Names of all static objects start with s_alloc_, memory report is
+// printed from linked image by tools/static_alloc_report.sh.
+//
+// APP_TASK_CREATE() in both modes stores stack depth of task in thread
+// local storage pointer APP_TLS_STACK_DEPTH, task monitor reports it.
+
+#ifndef STATIC_ALLOC_H
+#define STATIC_ALLOC_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+#ifndef APP_STATIC_ALLOCATION
+#error APP_STATIC_ALLOCATION is not defined in FreeRTOSConfig.h
+#endif
+
+// Thread local storage pointer with stack depth of task (in words)
+#define APP_TLS_STACK_DEPTH		0
+
+#if APP_TLS_STACK_DEPTH >= configNUM_THREAD_LOCAL_STORAGE_POINTERS
+#error configNUM_THREAD_LOCAL_STORAGE_POINTERS is too small for APP_TLS_STACK_DEPTH
+#endif
+
+// Result of task creation in the same form as xTaskCreate()
+inline BaseType_t StaticAllocTaskResult( TaskHandle_t t_task, uint32_t t_stack, TaskHandle_t *t_handle )
+{
+	if ( t_task ) vTaskSetThreadLocalStoragePointer( t_task, APP_TLS_STACK_DEPTH, ( void * ) t_stack );
+	if ( t_handle ) *t_handle = t_task;
+	return t_task ? pdPASS : errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
+}
+
+#if APP_STATIC_ALLOCATION
+
+#if configSUPPORT_STATIC_ALLOCATION != 1
+#error APP_STATIC_ALLOCATION requires configSUPPORT_STATIC_ALLOCATION 1
+#endif
+
+// Create task t_fn, returns pdPASS like xTaskCreate()
+#define APP_TASK_CREATE( t_fn, t_name, t_stack, t_arg, t_prio, t_handle ) \
+	( { \
+		static StackType_t s_alloc_##t_fn##_stack[ t_stack ]; \
+		static StaticTask_t s_alloc_##t_fn##_tcb; \
+		StaticAllocTaskResult( xTaskCreateStatic( t_fn, t_name, t_stack, t_arg, t_prio, \
+				s_alloc_##t_fn##_stack, &s_alloc_##t_fn##_tcb ), t_stack, t_handle ); \
+	} )
+
+// Create queue t_id for t_len items of t_size bytes
+#define APP_QUEUE_CREATE( t_id, t_len, t_size ) \
+	( { \
+		static uint8_t s_alloc_##t_id##_storage[ ( t_len ) * ( t_size ) ]; \
+		static StaticQueue_t s_alloc_##t_id##_queue; \
+		xQueueCreateStatic( t_len, t_size, s_alloc_##t_id##_storage, &s_alloc_##t_id##_queue ); \
+	} )
+
+// Create binary semaphore t_id
+#define APP_SEMAPHORE_CREATE_BINARY( t_id ) \
+	( { \
+		static StaticSemaphore_t s_alloc_##t_id##_sem; \
+		xSemaphoreCreateBinaryStatic( &s_alloc_##t_id##_sem ); \
+	} )
+
+#else // APP_STATIC_ALLOCATION
+
+#define APP_TASK_CREATE( t_fn, t_name, t_stack, t_arg, t_prio, t_handle ) \
+	( { \
+		TaskHandle_t l_alloc_task = NULL; \
+		xTaskCreate( t_fn, t_name, t_stack, t_arg, t_prio, &l_alloc_task ); \
+		StaticAllocTaskResult( l_alloc_task, t_stack, t_handle ); \
+	} )
+
+#define APP_QUEUE_CREATE( t_id, t_len, t_size ) \
+	xQueueCreate( t_len, t_size )
+
+#define APP_SEMAPHORE_CREATE_BINARY( t_id ) \
+	xSemaphoreCreateBinary()
+
+#endif // APP_STATIC_ALLOCATION
+
+#endif // STATIC_ALLOC_H
@@ -0,0 +1,124 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Switch gestures from GPIO interrupts
+//
+// **************************************************************************
+//
+// FreeRTOS kernel includes.
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+// System includes.
+#include "board.h"
+#include "pin_mux.h"
+#include "fsl_debug_console.h"
+#include "switch_gestures.h"
+#include "static_alloc.h"
+
+#define TASK_NAME_GESTURES		"gestures"
+
+#define EDGE_QUEUE_LEN			16
+
+// One edge of switch from ISR
+struct SwitchEdge
+{
+	uint8_t m_switch;
+	bool m_pressed;
+	TickType_t m_tick;
+};
+
+// pins of switches in order of switch index
+static const uint32_t g_sw_pin[ GESTURE_SWITCHES ] =
+		{ SW_PTC9_PIN, SW_PTC10_PIN, SW_PTC11_PIN, SW_PTC12_PIN };
+
+QueueHandle_t g_gesture_queue;
+
+static QueueHandle_t g_edge_queue;
+static GestureRecognizer g_recognizer;
+
+extern "C" {
+void PORTC_IRQHandler(void);
+}
+
+// ISR for PORTC
+void PORTC_IRQHandler(void)
+{
+	BaseType_t l_woken = pdFALSE;
+	uint32_t l_mask = GPIO_PortGetInterruptFlags( SW_PTC9_GPIO );
+	uint32_t l_levels = SW_PTC9_GPIO->PDIR;
+
+	SwitchEdge l_edge;
+	l_edge.m_tick = xTaskGetTickCountFromISR();
+
+	for ( uint32_t i = 0; i < GESTURE_SWITCHES; i++ )
+	{
+		if ( !( l_mask & ( 1U << g_sw_pin[ i ] ) ) ) continue;
+
+		// switches are active in low level
+		l_edge.m_switch = i;
+		l_edge.m_pressed = !( l_levels & ( 1U << g_sw_pin[ i ] ) );
+		xQueueSendFromISR( g_edge_queue, &l_edge, &l_woken );
+	}
+
+	// Clear exactly the flags which were handled
+	GPIO_PortClearInterruptFlags( SW_PTC9_GPIO, l_mask );
+
+	portYIELD_FROM_ISR( l_woken );
+}
+
+// Convert edges to gestures
+void task_gestures( void *t_arg )
+{
+	Gesture l_gestures[ GESTURE_OUT_MAX ];
+	SwitchEdge l_edge;
+
+	while ( 1 )
+	{
+		TickType_t l_now = xTaskGetTickCount();
+		uint32_t l_wait_ms = GestureNextTimeout( &g_recognizer, l_now * portTICK_PERIOD_MS );
+		TickType_t l_wait = ( l_wait_ms == GESTURE_NO_TIMEOUT ) ? portMAX_DELAY : pdMS_TO_TICKS( l_wait_ms );
+
+		int l_count;
+		if ( xQueueReceive( g_edge_queue, &l_edge, l_wait ) == pdTRUE )
+			l_count = GestureEdge( &g_recognizer, l_edge.m_switch, l_edge.m_pressed,
+					l_edge.m_tick * portTICK_PERIOD_MS, l_gestures );
+		else
+			l_count = GestureTimeout( &g_recognizer, xTaskGetTickCount() * portTICK_PERIOD_MS, l_gestures );
+
+		for ( int i = 0; i < l_count; i++ )
+		{
+			if ( xQueueSend( g_gesture_queue, &l_gestures[ i ], 0 ) != pdTRUE )
+				PRINTF( "Gesture queue is full!\r\n" );
+		}
+	}
+}
+
+// Initialize interrupts and create gesture task
+void InitSwitchGestures( uint8_t t_double_click_mask, uint8_t t_early_click_mask, UBaseType_t t_priority )
+{
+	GestureInit( &g_recognizer, t_double_click_mask, t_early_click_mask );
+
+	g_edge_queue = APP_QUEUE_CREATE( edge, EDGE_QUEUE_LEN, sizeof( SwitchEdge ) );
+	g_gesture_queue = APP_QUEUE_CREATE( gesture, GESTURE_QUEUE_LEN, sizeof( Gesture ) );
+
+	if ( APP_TASK_CREATE( task_gestures, TASK_NAME_GESTURES, configMINIMAL_STACK_SIZE + 100, NULL, t_priority, NULL ) != pdPASS )
+	{
+		PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_GESTURES );
+	}
+
+	// Set correct priority
+	NVIC_SetPriority( PORTC_IRQn, 3 );
+
+	// Both edges are needed for release and long press
+	for ( uint32_t i = 0; i < GESTURE_SWITCHES; i++ )
+		PORT_SetPinInterruptConfig( SW_PTC9_PORT, g_sw_pin[ i ], kPORT_InterruptEitherEdge );
+
+	EnableIRQ( PORTC_IRQn );
+}
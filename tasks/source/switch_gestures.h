@@ -0,0 +1,45 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Switch gestures from GPIO interrupts
+//
+// **************************************************************************
+//
+// PORTC ISR timestamps both edges of switches PTC9..PTC12 and sends them
+// to gesture task. Gesture task runs recognizer and sends every Gesture
+// into g_gesture_queue.
+//
+// Switch	Index
+// PTC9		0
+// PTC10	1
+// PTC11	2
+// PTC12	3
+
+#ifndef SWITCH_GESTURES_H
+#define SWITCH_GESTURES_H
+
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "gesture_recognizer.h"
+
+#define SW_INX_PTC9		0
+#define SW_INX_PTC10	1
+#define SW_INX_PTC11	2
+#define SW_INX_PTC12	3
+
+#define GESTURE_QUEUE_LEN	8
+
+// Queue of recognized gestures (struct Gesture)
+extern QueueHandle_t g_gesture_queue;
+
+// Initialize interrupts and create gesture task,
+// only switches in t_double_click_mask wait for DoubleClick,
+// switches in t_early_click_mask report Click without waiting.
+void InitSwitchGestures( uint8_t t_double_click_mask, uint8_t t_early_click_mask, UBaseType_t t_priority );
+
+#endif // SWITCH_GESTURES_H
@@ -0,0 +1,85 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Stack and heap usage of all tasks
+//
+// **************************************************************************
+//
+// FreeRTOS kernel includes.
+#include "FreeRTOS.h"
+#include "task.h"
+
+// System includes.
+#include "board.h"
+#include "fsl_debug_console.h"
+#include "task_monitor.h"
+#include "static_alloc.h"
+
+#if configUSE_TRACE_FACILITY != 1
+#error Task monitor requires configUSE_TRACE_FACILITY 1
+#endif
+
+#define TASK_NAME_MONITOR		"task_monitor"
+
+// Too big for stack of monitor
+static TaskStatus_t g_monitor_status[ TASK_MONITOR_MAX_TASKS ];
+static uint32_t g_monitor_period_ms;
+
+static char monitor_state( eTaskState t_state )
+{
+	switch ( t_state )
+	{
+	case eRunning:		return 'X';
+	case eReady:		return 'R';
+	case eBlocked:		return 'B';
+	case eSuspended:	return 'S';
+	case eDeleted:		return 'D';
+	default:			return '?';
+	}
+}
+
+// Print report of heap and all tasks
+void task_monitor( void *t_arg )
+{
+	while ( 1 )
+	{
+		vTaskDelay( pdMS_TO_TICKS( g_monitor_period_ms ) );
+
+		// high water mark is computed here for every task, scheduler is suspended meanwhile
+		UBaseType_t l_count = uxTaskGetSystemState( g_monitor_status, TASK_MONITOR_MAX_TASKS, NULL );
+		if ( !l_count )
+		{
+			PRINTF( "TM more than %d tasks!\r\n", TASK_MONITOR_MAX_TASKS );
+			continue;
+		}
+
+		PRINTF( "TM heap %u %u %u\r\n", xPortGetFreeHeapSize(), xPortGetMinimumEverFreeHeapSize(), configTOTAL_HEAP_SIZE );
+
+		for ( UBaseType_t i = 0; i < l_count; i++ )
+		{
+			TaskStatus_t *l_st = &g_monitor_status[ i ];
+			uint32_t l_depth = ( uint32_t ) pvTaskGetThreadLocalStoragePointer( l_st->xHandle, APP_TLS_STACK_DEPTH );
+
+			PRINTF( "TM task %s %c %u %u %u\r\n", l_st->pcTaskName, monitor_state( l_st->eCurrentState ),
+					l_st->uxCurrentPriority, l_depth, l_st->usStackHighWaterMark );
+		}
+
+		PRINTF( "TM end %u\r\n", l_count );
+	}
+}
+
+// Create monitor task
+void TaskMonitorInit( uint32_t t_period_ms, UBaseType_t t_priority )
+{
+	g_monitor_period_ms = t_period_ms;
+
+	if ( APP_TASK_CREATE( task_monitor, TASK_NAME_MONITOR, configMINIMAL_STACK_SIZE + 100, NULL, t_priority, NULL ) != pdPASS )
+	{
+		PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_MONITOR );
+	}
+}
@@ -251,6 +251,14 @@ FreeRTOS_SendPingRequest() API function is available. */
 (and associated) API function is available. */
 #define ipconfigSUPPORT_SELECT_FUNCTION				1
 
+/* If ipconfigSUPPORT_SIGNALS is set to 1 then FreeRTOS_SignalSocket() can wake
+up task blocked in FreeRTOS_select(), see tcp_server.cpp. */
+#define ipconfigSUPPORT_SIGNALS						1
+
+/* If ipconfigSOCKET_HAS_USER_SEMAPHORE is set to 1 then socket gives semaphore
+set by FREERTOS_SO_SET_SEMAPHORE on every event, see socket_client.cpp. */
+#define ipconfigSOCKET_HAS_USER_SEMAPHORE			1
+
 /* If ipconfigFILTER_OUT_NON_ETHERNET_II_FRAMES is set to 1 then Ethernet frames
 that are not in Ethernet II format will be dropped.  This option is included for
 potential future IP stack developments. */
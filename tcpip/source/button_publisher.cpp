@@ -0,0 +1,201 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Publisher of button changes woken by PORTC interrupt
+//
+// **************************************************************************
+//
+// FreeRTOS kernel includes.
+#include "FreeRTOS.h"
+#include "task.h"
+
+// System includes.
+#include <cstdio>
+#include <cstring>
+#include "board.h"
+#include "pin_mux.h"
+#include "fsl_port.h"
+#include "fsl_gpio.h"
+#include "fsl_debug_console.h"
+#include "button_publisher.h"
+#include "static_alloc.h"
+
+#define TASK_NAME_BUTTON_PUBLISHER	"button_pub"
+#define TASK_NAME_BUTTON_MONITOR	"button_mon"
+#define TASK_NAME_BUTTON_PRINT		"button_print"
+
+// All switches are on PORTC
+#define BUTTON_PORT				SW_PTC9_PORT
+#define BUTTON_GPIO				SW_PTC9_GPIO
+#define BUTTON_IRQn				PORTC_IRQn
+
+static uint32_t g_button_pins;
+static uint32_t g_button_count;
+static ButtonPublishCallback g_button_callback;
+static TaskHandle_t g_button_task = NULL;
+
+extern "C" {
+void PORTC_IRQHandler(void);
+}
+
+// ISR for PORTC, only wakes up publisher
+void PORTC_IRQHandler(void)
+{
+	BaseType_t l_woken = pdFALSE;
+
+	uint32_t l_mask = GPIO_PortGetInterruptFlags( BUTTON_GPIO );
+	GPIO_PortClearInterruptFlags( BUTTON_GPIO, l_mask );
+
+	if ( ( l_mask & g_button_pins ) && g_button_task )
+		vTaskNotifyGiveFromISR( g_button_task, &l_woken );
+
+	portYIELD_FROM_ISR( l_woken );
+}
+
+// Pressed buttons, button is pressed with level 0
+static uint8_t button_read()
+{
+	uint32_t l_level = ~BUTTON_GPIO->PDIR & g_button_pins;
+	uint8_t l_pressed = 0;
+
+	for ( uint32_t i = 0, l_pins = g_button_pins; l_pins; l_pins &= l_pins - 1, i++ )
+	{
+		if ( l_level & ( l_pins & -l_pins ) )
+			l_pressed |= 1U << i;
+	}
+	return l_pressed;
+}
+
+// Format snapshot for text and binary clients
+static void button_format( ButtonSnapshot *t_snap )
+{
+	char *l_text = t_snap->m_text;
+
+	*l_text++ = 'B';
+	*l_text++ = 'T';
+	*l_text++ = 'N';
+	*l_text++ = ' ';
+	for ( uint32_t i = 0; i < g_button_count; i++ )
+		*l_text++ = ( t_snap->m_pressed >> i ) & 1 ? '1' : '0';
+	*l_text++ = '\n';
+	*l_text++ = '\0';
+	t_snap->m_text_len = l_text - t_snap->m_text;
+
+	lp_encode( t_snap->m_frame, LP_OP_BUTTONS, lp_pack_buttons( t_snap->m_pressed, t_snap->m_changed ) );
+}
+
+void task_button_publisher( void *t_arg )
+{
+	uint8_t l_last = button_read();
+
+	while ( 1 )
+	{
+		ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+		// let switch settle, edges meanwhile give one snapshot
+		vTaskDelay( pdMS_TO_TICKS( BUTTON_COALESCE_MS ) );
+		ulTaskNotifyTake( pdTRUE, 0 );
+
+		uint8_t l_pressed = button_read();
+		if ( l_pressed == l_last ) continue;
+
+		ButtonSnapshot l_snap;
+		l_snap.m_pressed = l_pressed;
+		l_snap.m_changed = l_pressed ^ l_last;
+		button_format( &l_snap );
+		l_last = l_pressed;
+
+		g_button_callback( &l_snap );
+	}
+}
+
+#if BUTTON_POLLING_BASELINE
+static uint8_t g_button_polled;				// pressed buttons
+static uint8_t g_button_polled_changed;		// changed since last print
+
+// Old way for comparison of CPU load, buttons are read in every tick
+void task_button_monitor( void *t_arg )
+{
+	uint8_t l_last = button_read();
+	g_button_polled = l_last;
+
+	while ( 1 )
+	{
+		uint8_t l_pressed = button_read();
+
+		taskENTER_CRITICAL();
+		g_button_polled = l_pressed;
+		g_button_polled_changed |= l_pressed ^ l_last;
+		taskEXIT_CRITICAL();
+		l_last = l_pressed;
+
+		vTaskDelay( 1 );
+	}
+}
+
+// Old way, state is formatted by sprintf in every tick and published when changed
+void task_button_print( void *t_arg )
+{
+	while ( 1 )
+	{
+		ButtonSnapshot l_snap;
+
+		taskENTER_CRITICAL();
+		l_snap.m_pressed = g_button_polled;
+		l_snap.m_changed = g_button_polled_changed;
+		g_button_polled_changed = 0;
+		taskEXIT_CRITICAL();
+
+		strcpy( l_snap.m_text, "BTN " );
+		for ( uint32_t i = 0; i < g_button_count; i++ )
+			sprintf( l_snap.m_text + strlen( l_snap.m_text ), "%d", ( l_snap.m_pressed >> i ) & 1 );
+		strcat( l_snap.m_text, "\n" );
+		l_snap.m_text_len = strlen( l_snap.m_text ) + 1;
+		lp_encode( l_snap.m_frame, LP_OP_BUTTONS, lp_pack_buttons( l_snap.m_pressed, l_snap.m_changed ) );
+
+		if ( l_snap.m_changed )
+			g_button_callback( &l_snap );
+
+		vTaskDelay( 1 );
+	}
+}
+#endif // BUTTON_POLLING_BASELINE
+
+// Create publisher task and enable interrupt
+void ButtonPublisherInit( uint32_t t_pin_mask, ButtonPublishCallback t_callback, UBaseType_t t_priority )
+{
+	g_button_pins = t_pin_mask;
+	g_button_count = __builtin_popcount( t_pin_mask );
+	g_button_callback = t_callback;
+
+	configASSERT( g_button_count <= BUTTON_MAX );
+
+#if BUTTON_POLLING_BASELINE
+	PRINTF( "Buttons are polled every tick.\r\n" );
+	if ( APP_TASK_CREATE( task_button_monitor, TASK_NAME_BUTTON_MONITOR, configMINIMAL_STACK_SIZE + 100,
+			NULL, t_priority, NULL ) != pdPASS )
+		PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_BUTTON_MONITOR );
+	if ( APP_TASK_CREATE( task_button_print, TASK_NAME_BUTTON_PRINT, configMINIMAL_STACK_SIZE + 200,
+			NULL, t_priority, NULL ) != pdPASS )
+		PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_BUTTON_PRINT );
+#else
+	if ( APP_TASK_CREATE( task_button_publisher, TASK_NAME_BUTTON_PUBLISHER, configMINIMAL_STACK_SIZE + 200,
+			NULL, t_priority, &g_button_task ) != pdPASS )
+	{
+		PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_BUTTON_PUBLISHER );
+		return;
+	}
+
+	for ( uint32_t l_pins = t_pin_mask; l_pins; l_pins &= l_pins - 1 )
+		PORT_SetPinInterruptConfig( BUTTON_PORT, __builtin_ctz( l_pins ), kPORT_InterruptEitherEdge );
+
+	// FreeRTOS API is allowed in ISR, priority is below configMAX_SYSCALL_INTERRUPT_PRIORITY
+	NVIC_SetPriority( BUTTON_IRQn, 3 );
+	EnableIRQ( BUTTON_IRQn );
+#endif // BUTTON_POLLING_BASELINE
+}
@@ -0,0 +1,57 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Publisher of button changes woken by PORTC interrupt
+//
+// **************************************************************************
+//
+// Buttons on PORTC interrupt on either edge. ISR only wakes up publisher
+// task. Task waits BUTTON_COALESCE_MS for end of bouncing and for other
+// buttons, then reads all buttons at once. If state differs from last
+// published one, snapshot is passed to callback. Burst of edges gives one
+// snapshot, task sleeps while no button moves.
+//
+// Snapshot contains state already formatted for both protocols, text line
+// "BTN 0101\n" with terminating zero and LP_OP_BUTTONS frame, so it is
+// formatted once and not for every client.
+//
+// BUTTON_POLLING_BASELINE 1 builds the old way instead, for comparison of
+// "TM idle" in one tree: one task reads buttons in every tick, other one
+// formats state by sprintf in every tick and publishes changes.
+
+#ifndef BUTTON_PUBLISHER_H
+#define BUTTON_PUBLISHER_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "led_proto.h"
+
+#define BUTTON_MAX				8
+#define BUTTON_COALESCE_MS		5
+
+// 1 = buttons polled every tick by two tasks as before, no interrupt
+#define BUTTON_POLLING_BASELINE	0
+#define BUTTON_TEXT_SIZE		( 4 + BUTTON_MAX + 2 )
+
+struct ButtonSnapshot
+{
+	uint8_t m_pressed;						// bit i is button i
+	uint8_t m_changed;						// buttons changed since last snapshot
+	uint8_t m_text_len;						// with terminating zero
+	char m_text[ BUTTON_TEXT_SIZE ];		// "BTN 0101\n"
+	uint8_t m_frame[ LP_HEADER_SIZE ];		// LP_OP_BUTTONS
+};
+
+// Called by publisher task for every change
+typedef void ( *ButtonPublishCallback )( const ButtonSnapshot *t_snapshot );
+
+// Buttons are PORTC pins in t_pin_mask, button 0 is the lowest pin.
+// Create publisher task and enable interrupt.
+void ButtonPublisherInit( uint32_t t_pin_mask, ButtonPublishCallback t_callback, UBaseType_t t_priority );
+
+#endif // BUTTON_PUBLISHER_H
@@ -0,0 +1,120 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         GPIO pins and groups of pins known at compile time
+//
+// **************************************************************************
+//
+// Pin< GPIOC_BASE, 3 > is one pin, PinGroup< Pin..., Pin... > is group of
+// pins on the same port. All masks are computed by compiler, so write of
+// whole group is one PCOR and one PSOR store instead of GPIO_PinWrite()
+// for every pin.
+//
+// Bit i of value written to PinGroup belongs to i-th pin of group.
+//
+// Pin::bitband() is Cortex-M4 bit-band alias of pin in PDOR, one store
+// to it changes only this pin without read-modify-write.
+
+#ifndef GPIO_PINS_H
+#define GPIO_PINS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "fsl_gpio.h"
+
+// Peripheral bit-band region and its alias
+#define GPIO_PINS_BITBAND_BASE		0x40000000u
+#define GPIO_PINS_BITBAND_ALIAS		0x42000000u
+
+template < uint32_t t_gpio_base, uint32_t t_pin >
+struct Pin
+{
+	static_assert( t_pin < 32, "GPIO port has only 32 pins" );
+
+	static constexpr uint32_t gpio_base = t_gpio_base;
+	static constexpr uint32_t mask = 1U << t_pin;
+
+	// Address of PDOR bit in bit-band alias region
+	static constexpr uint32_t bitband_addr = GPIO_PINS_BITBAND_ALIAS
+			+ ( t_gpio_base + offsetof( GPIO_Type, PDOR ) - GPIO_PINS_BITBAND_BASE ) * 32 + t_pin * 4;
+
+	static GPIO_Type *gpio() { return ( GPIO_Type * ) t_gpio_base; }
+
+	static void set() { gpio()->PSOR = mask; }
+	static void clear() { gpio()->PCOR = mask; }
+	static void toggle() { gpio()->PTOR = mask; }
+	static void write( bool t_on ) { if ( t_on ) set(); else clear(); }
+	static bool read() { return ( gpio()->PDIR & mask ) != 0; }
+
+	static volatile uint32_t &bitband() { return *( volatile uint32_t * ) bitband_addr; }
+	static void write_atomic( bool t_on ) { bitband() = t_on; }
+};
+
+template < typename... t_pins >
+struct PinGroup;
+
+template <>
+struct PinGroup<>
+{
+	static constexpr uint32_t gpio_base = 0;
+	static constexpr uint32_t count = 0;
+	static constexpr uint32_t mask = 0;
+
+	static constexpr uint32_t port_bits( uint32_t t_bits ) { return 0; }
+};
+
+template < typename t_first, typename... t_rest >
+struct PinGroup< t_first, t_rest... >
+{
+	typedef PinGroup< t_rest... > Rest;
+
+	static_assert( Rest::count == 0 || t_first::gpio_base == Rest::gpio_base,
+			"All pins of group must be on one port" );
+
+	static constexpr uint32_t gpio_base = t_first::gpio_base;
+	static constexpr uint32_t count = 1 + Rest::count;
+	static constexpr uint32_t mask = t_first::mask | Rest::mask;
+
+	static GPIO_Type *gpio() { return ( GPIO_Type * ) gpio_base; }
+
+	// Convert bits of group to bits of port
+	static constexpr uint32_t port_bits( uint32_t t_bits )
+	{
+		return ( ( t_bits & 1 ) ? t_first::mask : 0 ) | Rest::port_bits( t_bits >> 1 );
+	}
+
+	// Write all pins of group
+	static void write( uint32_t t_bits )
+	{
+		uint32_t l_on = port_bits( t_bits );
+		gpio()->PCOR = mask & ~l_on;
+		gpio()->PSOR = l_on;
+	}
+
+	// Write constant value, both masks are computed by compiler
+	template < uint32_t t_bits >
+	static void write()
+	{
+		gpio()->PCOR = mask & ~port_bits( t_bits );
+		gpio()->PSOR = port_bits( t_bits );
+	}
+
+	// Change only pins which differ between t_old and t_new
+	static void update( uint32_t t_old, uint32_t t_new )
+	{
+		uint32_t l_diff = port_bits( t_old ^ t_new );
+		uint32_t l_on = port_bits( t_new ) & l_diff;
+		if ( l_diff & ~l_on ) gpio()->PCOR = l_diff & ~l_on;
+		if ( l_on ) gpio()->PSOR = l_on;
+	}
+
+	static void set_all() { gpio()->PSOR = mask; }
+	static void clear_all() { gpio()->PCOR = mask; }
+};
+
+#endif // GPIO_PINS_H
@@ -0,0 +1,117 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Pool of worker tasks for short jobs
+//
+// **************************************************************************
+//
+// FreeRTOS kernel includes.
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+// System includes.
+#include <cstdio>
+#include "fsl_debug_console.h"
+#include "job_pool.h"
+#include "static_alloc.h"
+
+#define TASK_NAME_JOB_WORKER	"job_worker%u"
+
+struct Job
+{
+	JobFunction m_function;
+	void *m_arg;
+	TickType_t m_submit;
+};
+
+static QueueHandle_t g_job_queue = NULL;
+static JobPoolStats g_job_stats;
+
+#if APP_STATIC_ALLOCATION
+// APP_TASK_CREATE() can create only one task, workers have own arrays
+static StackType_t s_alloc_job_worker_stack[ JOB_POOL_WORKERS ][ JOB_POOL_STACK_SIZE ];
+static StaticTask_t s_alloc_job_worker_tcb[ JOB_POOL_WORKERS ];
+#endif
+
+void task_job_worker( void *t_arg )
+{
+	Job l_job;
+
+	while ( 1 )
+	{
+		xQueueReceive( g_job_queue, &l_job, portMAX_DELAY );
+
+		uint32_t l_wait_ms = ( xTaskGetTickCount() - l_job.m_submit ) * portTICK_PERIOD_MS;
+
+		taskENTER_CRITICAL();
+		g_job_stats.m_last_wait_ms = l_wait_ms;
+		if ( l_wait_ms > g_job_stats.m_max_wait_ms ) g_job_stats.m_max_wait_ms = l_wait_ms;
+		taskEXIT_CRITICAL();
+
+		l_job.m_function( l_job.m_arg );
+
+		JobPoolStats l_stats;
+		taskENTER_CRITICAL();
+		g_job_stats.m_done++;
+		l_stats = g_job_stats;
+		taskEXIT_CRITICAL();
+
+		PRINTF( "JP done %u rejected %u depth %u %u wait %u %u ms\r\n", l_stats.m_done, l_stats.m_rejected,
+				uxQueueMessagesWaiting( g_job_queue ), l_stats.m_max_depth, l_stats.m_last_wait_ms, l_stats.m_max_wait_ms );
+	}
+}
+
+// Create workers
+void JobPoolInit( UBaseType_t t_priority )
+{
+	g_job_queue = APP_QUEUE_CREATE( job_pool, JOB_POOL_QUEUE_LEN, sizeof( Job ) );
+
+	for ( uint32_t i = 0; i < JOB_POOL_WORKERS; i++ )
+	{
+		char l_name[ configMAX_TASK_NAME_LEN ];
+		snprintf( l_name, sizeof( l_name ), TASK_NAME_JOB_WORKER, i );
+
+#if APP_STATIC_ALLOCATION
+		TaskHandle_t l_task = xTaskCreateStatic( task_job_worker, l_name, JOB_POOL_STACK_SIZE, NULL, t_priority,
+				s_alloc_job_worker_stack[ i ], &s_alloc_job_worker_tcb[ i ] );
+#else
+		TaskHandle_t l_task = NULL;
+		xTaskCreate( task_job_worker, l_name, JOB_POOL_STACK_SIZE, NULL, t_priority, &l_task );
+#endif
+
+		if ( StaticAllocTaskResult( l_task, JOB_POOL_STACK_SIZE, NULL ) != pdPASS )
+		{
+			PRINTF( "Unable to create task '%s'!\r\n", l_name );
+		}
+	}
+}
+
+// Queue job without waiting
+bool JobPoolSubmit( JobFunction t_function, void *t_arg )
+{
+	Job l_job = { t_function, t_arg, xTaskGetTickCount() };
+	bool l_ok = xQueueSend( g_job_queue, &l_job, 0 ) == pdPASS;
+	uint32_t l_depth = uxQueueMessagesWaiting( g_job_queue );
+
+	taskENTER_CRITICAL();
+	g_job_stats.m_submitted++;
+	if ( !l_ok ) g_job_stats.m_rejected++;
+	if ( l_depth > g_job_stats.m_max_depth ) g_job_stats.m_max_depth = l_depth;
+	taskEXIT_CRITICAL();
+
+	return l_ok;
+}
+
+// Copy of statistics
+void JobPoolGetStats( JobPoolStats *t_stats )
+{
+	taskENTER_CRITICAL();
+	*t_stats = g_job_stats;
+	taskEXIT_CRITICAL();
+}
@@ -0,0 +1,55 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Pool of worker tasks for short jobs
+//
+// **************************************************************************
+//
+// JOB_POOL_WORKERS tasks are created at start and wait for jobs in one
+// queue of JOB_POOL_QUEUE_LEN jobs. Job is function with argument. When
+// all workers are busy and queue is full, new job is rejected, so burst
+// of requests can not exhaust heap as task created for every request.
+//
+// After every job one line with statistics is printed:
+//
+// JP done <jobs> rejected <jobs> depth <now> <max> wait <last> <max> ms
+//
+// Wait is time of job in queue, depth is number of jobs waiting in queue.
+
+#ifndef JOB_POOL_H
+#define JOB_POOL_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define JOB_POOL_WORKERS		2
+#define JOB_POOL_QUEUE_LEN		2
+#define JOB_POOL_STACK_SIZE		( configMINIMAL_STACK_SIZE + 100 )
+
+typedef void ( *JobFunction )( void *t_arg );
+
+struct JobPoolStats
+{
+	uint32_t m_submitted;
+	uint32_t m_rejected;
+	uint32_t m_done;
+	uint32_t m_max_depth;
+	uint32_t m_last_wait_ms;
+	uint32_t m_max_wait_ms;
+};
+
+// Create workers with priority t_priority
+void JobPoolInit( UBaseType_t t_priority );
+
+// Queue job without waiting, false if job is rejected
+bool JobPoolSubmit( JobFunction t_function, void *t_arg );
+
+// Copy of statistics
+void JobPoolGetStats( JobPoolStats *t_stats );
+
+#endif // JOB_POOL_H
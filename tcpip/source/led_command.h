@@ -0,0 +1,211 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Parser of text LED commands from TCP stream
+//
+// **************************************************************************
+//
+// TCP does not keep boundaries of messages. One FreeRTOS_recv() may return
+// more commands or only part of one. LedLineParser stores received bytes
+// in ring buffer of connection and calls parse_led_command() for every
+// complete line. Lines complete within one segment are parsed in place,
+// only partial line at end of segment is kept in ring. Line ends with
+// '\n', '\r' or '\0' (clients send string with its terminating zero).
+// Empty lines are skipped, too long line is dropped up to its end.
+//
+// Header has no dependency on FreeRTOS, it is used by tools/led_parser_bench.cpp
+// on host, too.
+
+#ifndef LED_COMMAND_H
+#define LED_COMMAND_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum { LEFT, RIGHT } Direction_t;
+
+// Parse one command "LED L|R n"
+inline bool parse_led_command(const char* input, Direction_t* dir, int* num) {
+
+    char led_str[] = "LED";
+    int i = 0;
+
+
+    while (input[i] == ' ') i++;
+
+
+    int j = 0;
+    while (led_str[j] != '\0') {
+        if (input[i] != led_str[j]) {
+            return false;
+        }
+        i++;
+        j++;
+    }
+
+
+    while (input[i] == ' ') i++;
+
+
+    if (input[i] == 'L' || input[i] == 'l') {
+        *dir = LEFT;
+    } else if (input[i] == 'R' || input[i] == 'r') {
+        *dir = RIGHT;
+    } else {
+        return false;
+    }
+    i++;
+
+    while (input[i] == ' ') i++;
+
+    if (input[i] >= '0' && input[i] <= '9') {
+        *num = 0;
+        while (input[i] >= '0' && input[i] <= '9') {
+            *num = (*num) * 10 + (input[i] - '0');
+            i++;
+        }
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+// Mask of LEDs for command, bit 0 is the most left LED of t_count
+inline uint32_t led_command_mask( Direction_t t_dir, int t_num, int t_count )
+{
+	if ( t_num <= 0 ) return 0;
+	if ( t_num > t_count ) t_num = t_count;
+
+	uint32_t l_bits = ( t_num >= 32 ) ? 0xFFFFFFFF : ( 1U << t_num ) - 1;
+	return t_dir == LEFT ? l_bits : l_bits << ( t_count - t_num );
+}
+
+// Size of ring, must be power of 2 and more than LED_LINE_MAX
+#define LED_LINE_RING_SIZE		64
+// Longest accepted line without terminator
+#define LED_LINE_MAX			32
+
+class LedLineParser
+{
+public:
+	LedLineParser() { reset(); }
+
+	// Forget partial line, for new connection
+	void reset()
+	{
+		m_head = m_tail = 0;
+		m_drop = false;
+	}
+
+	// Parse t_len received bytes and call t_cmd( line, line_len, ok, dir, num )
+	// for every complete line, line is not zero terminated. Callback returns
+	// false to stop after its line. Returns number of used bytes.
+	template < typename t_callback >
+	size_t feed( const uint8_t *t_data, size_t t_len, t_callback t_cmd )
+	{
+		size_t l_used = 0;
+
+		while ( l_used < t_len )
+		{
+			const uint8_t *l_line = t_data + l_used;
+			size_t l_rest = t_len - l_used;
+			size_t l_eol = 0;
+			while ( l_eol < l_rest && !is_eol( l_line[ l_eol ] ) ) l_eol++;
+
+			// no end of line, keep partial line for next segment
+			if ( l_eol == l_rest )
+			{
+				store( l_line, l_rest );
+				return t_len;
+			}
+
+			l_used += l_eol + 1;
+
+			bool l_next = true;
+			if ( m_head != m_tail || m_drop )
+			{
+				// end of line started in previous segment
+				store( l_line, l_eol );
+				l_next = line_from_ring( t_cmd );
+			}
+			else if ( l_eol )
+			{
+				// whole line is in segment, it is parsed in place
+				l_next = line( ( const char * ) l_line, l_eol, t_cmd );
+			}
+
+			if ( !l_next ) break;
+		}
+		return l_used;
+	}
+
+	// Bytes of incomplete line
+	uint32_t pending() const { return m_head - m_tail; }
+
+private:
+	char m_ring[ LED_LINE_RING_SIZE ];
+	uint32_t m_head;		// free running write index
+	uint32_t m_tail;		// start of incomplete line
+	bool m_drop;			// line is too long, skip to its end
+
+	static bool is_eol( uint8_t t_c ) { return t_c == '\n' || t_c == '\r' || t_c == '\0'; }
+
+	// Append part of line to ring
+	void store( const uint8_t *t_data, size_t t_len )
+	{
+		if ( m_drop ) return;
+
+		if ( pending() + t_len > LED_LINE_MAX )
+		{
+			// too long, only its end is looked for
+			m_drop = true;
+			m_tail = m_head;
+			return;
+		}
+
+		for ( size_t i = 0; i < t_len; i++ )
+			m_ring[ m_head++ & ( LED_LINE_RING_SIZE - 1 ) ] = t_data[ i ];
+	}
+
+	// Line in ring is complete, copy it out and parse it
+	template < typename t_callback >
+	bool line_from_ring( t_callback &t_cmd )
+	{
+		char l_line[ LED_LINE_MAX + 1 ];
+		uint32_t l_len = pending();
+		bool l_next = true;
+
+		for ( uint32_t i = 0; i < l_len; i++ )
+			l_line[ i ] = m_ring[ ( m_tail + i ) & ( LED_LINE_RING_SIZE - 1 ) ];
+		l_line[ l_len ] = '\0';
+
+		bool l_parse = !m_drop && l_len;
+		m_tail = m_head;
+		m_drop = false;
+
+		if ( l_parse )
+			l_next = line( l_line, l_len, t_cmd );
+		return l_next;
+	}
+
+	// Parse one line, parse_led_command() stops on its terminator
+	template < typename t_callback >
+	bool line( const char *t_line, uint32_t t_len, t_callback &t_cmd )
+	{
+		Direction_t l_dir = LEFT;
+		int l_num = 0;
+
+		if ( t_len > LED_LINE_MAX ) return true;
+
+		bool l_ok = parse_led_command( t_line, &l_dir, &l_num );
+		return t_cmd( t_line, t_len, l_ok, l_dir, l_num );
+	}
+};
+
+#endif // LED_COMMAND_H
@@ -0,0 +1,145 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Output stage of LEDs driven by published mask
+//
+// **************************************************************************
+//
+// FreeRTOS kernel includes.
+#include "FreeRTOS.h"
+#include "task.h"
+
+// System includes.
+#include <atomic>
+#include <cstring>
+#include "fsl_debug_console.h"
+#include "led_output.h"
+#include "static_alloc.h"
+
+#define TASK_NAME_LED_OUTPUT	"led_output"
+
+#define LED_WORD_MASK			( ( 1U << LED_OUTPUT_MASK_BITS ) - 1 )
+#define LED_WORD_VERSION		( 1U << LED_OUTPUT_MASK_BITS )
+
+// mask and version of last published state
+static std::atomic< uint32_t > g_led_word( 0 );
+
+static LedWriteFunction g_led_write;
+static TaskHandle_t g_led_task = NULL;
+
+// Animation, changed only in critical section
+static uint8_t g_led_anim[ LED_OUTPUT_ANIM_MAX ];
+static uint32_t g_led_anim_len = 0;
+static TickType_t g_led_anim_step = 0;
+static bool g_led_anim_new = false;
+
+void task_led_output( void *t_arg )
+{
+	uint32_t l_version = 0;			// version of applied word
+	uint32_t l_pins = 0;			// mask written to pins
+	uint32_t l_frame = 0;
+	uint32_t l_anim_len = 0;
+	TickType_t l_anim_step = portMAX_DELAY;
+
+	g_led_write( LED_WORD_MASK, 0 );
+
+	while ( 1 )
+	{
+		// without animation sleep until next publish
+		bool l_notified = ulTaskNotifyTake( pdTRUE, l_anim_len ? l_anim_step : portMAX_DELAY ) != 0;
+
+		uint32_t l_word = g_led_word.load( std::memory_order_acquire );
+		uint32_t l_next = l_pins;
+
+		taskENTER_CRITICAL();
+		if ( g_led_anim_new )
+		{
+			g_led_anim_new = false;
+			l_anim_len = g_led_anim_len;
+			l_anim_step = g_led_anim_step;
+			l_frame = 0;
+			l_next = g_led_anim[ 0 ];
+		}
+		else if ( l_anim_len && !l_notified )
+		{
+			l_frame = ( l_frame + 1 ) % l_anim_len;
+			l_next = g_led_anim[ l_frame ];
+		}
+		l_anim_len = g_led_anim_len;
+		taskEXIT_CRITICAL();
+
+		// new mask replaces animation
+		if ( ( l_word & ~LED_WORD_MASK ) != l_version )
+		{
+			l_version = l_word & ~LED_WORD_MASK;
+			if ( !l_anim_len )
+				l_next = l_word & LED_WORD_MASK;
+		}
+
+		if ( l_next != l_pins )
+		{
+			g_led_write( l_pins, l_next );
+			l_pins = l_next;
+		}
+	}
+}
+
+// Create output task
+void LedOutputInit( LedWriteFunction t_write, UBaseType_t t_priority )
+{
+	g_led_write = t_write;
+
+	if ( APP_TASK_CREATE( task_led_output, TASK_NAME_LED_OUTPUT, configMINIMAL_STACK_SIZE + 100,
+			NULL, t_priority, &g_led_task ) != pdPASS )
+	{
+		PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_LED_OUTPUT );
+	}
+}
+
+// Publish new mask and wake up output task
+void LedOutputPublish( uint32_t t_mask )
+{
+	taskENTER_CRITICAL();
+	g_led_anim_len = 0;
+	g_led_anim_new = false;
+	taskEXIT_CRITICAL();
+
+	uint32_t l_old = g_led_word.load( std::memory_order_relaxed );
+	uint32_t l_new;
+	do
+	{
+		l_new = ( ( l_old & ~LED_WORD_MASK ) + LED_WORD_VERSION ) | ( t_mask & LED_WORD_MASK );
+	}
+	while ( !g_led_word.compare_exchange_weak( l_old, l_new, std::memory_order_release, std::memory_order_relaxed ) );
+
+	if ( g_led_task ) xTaskNotifyGive( g_led_task );
+}
+
+// Start animation
+void LedOutputAnimate( const uint8_t *t_frames, uint32_t t_len, uint32_t t_step_ms )
+{
+	if ( !t_len ) return;
+	if ( t_len > LED_OUTPUT_ANIM_MAX ) t_len = LED_OUTPUT_ANIM_MAX;
+
+	TickType_t l_step = pdMS_TO_TICKS( t_step_ms );
+
+	taskENTER_CRITICAL();
+	memcpy( g_led_anim, t_frames, t_len );
+	g_led_anim_len = t_len;
+	g_led_anim_step = l_step ? l_step : 1;
+	g_led_anim_new = true;
+	taskEXIT_CRITICAL();
+
+	if ( g_led_task ) xTaskNotifyGive( g_led_task );
+}
+
+// Last published mask
+uint32_t LedOutputMask()
+{
+	return g_led_word.load( std::memory_order_relaxed ) & LED_WORD_MASK;
+}
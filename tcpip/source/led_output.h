@@ -0,0 +1,45 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Output stage of LEDs driven by published mask
+//
+// **************************************************************************
+//
+// State of LEDs is one atomic word, mask in low LED_OUTPUT_MASK_BITS bits
+// and version counter in the rest. Writer publishes whole new mask and
+// notifies output task. Output task sleeps until notification, compares
+// version with the last applied one and writes only changed pins.
+//
+// Animation is played by output task, too. Task then wakes up only for
+// next step. Any published mask stops animation.
+
+#ifndef LED_OUTPUT_H
+#define LED_OUTPUT_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define LED_OUTPUT_MASK_BITS	8
+#define LED_OUTPUT_ANIM_MAX		32
+
+// Write pins changed between t_old and t_new, e.g. PinGroup::update()
+typedef void ( *LedWriteFunction )( uint32_t t_old, uint32_t t_new );
+
+// Create output task, all LEDs are off
+void LedOutputInit( LedWriteFunction t_write, UBaseType_t t_priority );
+
+// Publish new mask, bit i is LED i, stops animation
+void LedOutputPublish( uint32_t t_mask );
+
+// Repeat t_len masks, one per t_step_ms
+void LedOutputAnimate( const uint8_t *t_frames, uint32_t t_len, uint32_t t_step_ms );
+
+// Last published mask
+uint32_t LedOutputMask();
+
+#endif // LED_OUTPUT_H
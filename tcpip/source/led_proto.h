@@ -0,0 +1,169 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Binary protocol for LEDs and buttons
+//
+// **************************************************************************
+//
+// Connection starts in text mode. Client sends line LP_MODE_LINE, server
+// replies with the same line and from next byte both sides use frames:
+//
+//   byte 0     opcode
+//   byte 1     length of payload, max LP_MAX_PAYLOAD
+//   byte 2..3  argument, little endian
+//   byte 4..   payload
+//
+// Client -> server:
+//
+//   LP_OP_SET_MASK    arg: bit i is LED i, no payload
+//   LP_OP_ANIMATE     arg: step in ms, payload: one mask per step, repeated
+//                     until next LP_OP_SET_MASK or LP_OP_ANIMATE
+//   LP_OP_SUBSCRIBE   arg: LP_SUB_* events sent to client
+//
+// Server -> client:
+//
+//   LP_OP_BUTTONS     arg: bits 0..7 pressed buttons, bits 8..15 changed
+//   LP_OP_ERROR       arg: opcode of refused frame
+//
+// Client must wait for reply to LP_MODE_LINE before first frame. Header has
+// no dependency on FreeRTOS, it is used by socket_cl.cpp, too.
+
+#ifndef LED_PROTO_H
+#define LED_PROTO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define LP_MODE_LINE			"MODE BIN"
+
+#define LP_HEADER_SIZE			4
+#define LP_MAX_PAYLOAD			32
+
+#define LP_OP_SET_MASK			0x01
+#define LP_OP_ANIMATE			0x02
+#define LP_OP_SUBSCRIBE			0x03
+#define LP_OP_BUTTONS			0x81
+#define LP_OP_ERROR				0xFF
+
+#define LP_SUB_BUTTONS			0x0001
+
+struct LpFrame
+{
+	uint8_t m_op;
+	uint8_t m_len;
+	uint16_t m_arg;
+	uint8_t m_payload[ LP_MAX_PAYLOAD ];
+};
+
+// Write frame into t_buf, it must have LP_HEADER_SIZE + t_len bytes.
+// Returns size of frame.
+inline size_t lp_encode( uint8_t *t_buf, uint8_t t_op, uint16_t t_arg,
+		const uint8_t *t_payload = nullptr, uint8_t t_len = 0 )
+{
+	t_buf[ 0 ] = t_op;
+	t_buf[ 1 ] = t_len;
+	t_buf[ 2 ] = t_arg & 0xFF;
+	t_buf[ 3 ] = t_arg >> 8;
+	for ( uint8_t i = 0; i < t_len; i++ )
+		t_buf[ LP_HEADER_SIZE + i ] = t_payload[ i ];
+	return LP_HEADER_SIZE + t_len;
+}
+
+inline uint16_t lp_pack_buttons( uint8_t t_pressed, uint8_t t_changed )
+{
+	return t_pressed | ( t_changed << 8 );
+}
+
+// Size of frame at t_data, 0 if t_len bytes hold only its part.
+// Frame is used in place, without LpDecoder.
+inline size_t lp_frame_size( const uint8_t *t_data, size_t t_len )
+{
+	if ( t_len < LP_HEADER_SIZE || t_len < ( size_t ) LP_HEADER_SIZE + t_data[ 1 ] ) return 0;
+	return LP_HEADER_SIZE + t_data[ 1 ];
+}
+
+inline uint16_t lp_frame_arg( const uint8_t *t_frame )
+{
+	return t_frame[ 2 ] | ( t_frame[ 3 ] << 8 );
+}
+
+// Frames from stream, keeps partial frame between segments
+class LpDecoder
+{
+public:
+	LpDecoder() { reset(); }
+
+	void reset()
+	{
+		m_have = 0;
+		m_skip = 0;
+	}
+
+	// Call t_frame( const LpFrame & ) for every complete frame. Frame with
+	// too long payload is skipped and passed with m_len 0 and LP_OP_ERROR
+	// in m_op, original opcode in m_arg. Returns number of frames.
+	template < typename t_callback >
+	uint32_t feed( const uint8_t *t_data, size_t t_len, t_callback t_frame )
+	{
+		uint32_t l_frames = 0;
+
+		while ( t_len )
+		{
+			if ( m_skip )
+			{
+				size_t l_skip = t_len < m_skip ? t_len : m_skip;
+				m_skip -= l_skip;
+				t_data += l_skip;
+				t_len -= l_skip;
+				continue;
+			}
+
+			// header first, then payload of length from header
+			size_t l_need = m_have < LP_HEADER_SIZE ? LP_HEADER_SIZE : LP_HEADER_SIZE + m_buf[ 1 ];
+			size_t l_copy = l_need - m_have;
+			if ( l_copy > t_len ) l_copy = t_len;
+
+			for ( size_t i = 0; i < l_copy; i++ )
+				m_buf[ m_have + i ] = t_data[ i ];
+			m_have += l_copy;
+			t_data += l_copy;
+			t_len -= l_copy;
+
+			if ( m_have == LP_HEADER_SIZE && m_buf[ 1 ] > LP_MAX_PAYLOAD )
+			{
+				LpFrame l_error = { LP_OP_ERROR, 0, m_buf[ 0 ], { 0 } };
+				m_skip = m_buf[ 1 ];
+				m_have = 0;
+				t_frame( l_error );
+				l_frames++;
+				continue;
+			}
+
+			if ( m_have >= LP_HEADER_SIZE && m_have == ( size_t ) LP_HEADER_SIZE + m_buf[ 1 ] )
+			{
+				LpFrame l_frame;
+				l_frame.m_op = m_buf[ 0 ];
+				l_frame.m_len = m_buf[ 1 ];
+				l_frame.m_arg = m_buf[ 2 ] | ( m_buf[ 3 ] << 8 );
+				for ( uint8_t i = 0; i < l_frame.m_len; i++ )
+					l_frame.m_payload[ i ] = m_buf[ LP_HEADER_SIZE + i ];
+				m_have = 0;
+				t_frame( l_frame );
+				l_frames++;
+			}
+		}
+		return l_frames;
+	}
+
+private:
+	uint8_t m_buf[ LP_HEADER_SIZE + LP_MAX_PAYLOAD ];
+	size_t m_have;			// bytes of partial frame in m_buf
+	size_t m_skip;			// bytes of refused payload to skip
+};
+
+#endif // LED_PROTO_H
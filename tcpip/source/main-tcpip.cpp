@@ -17,6 +17,18 @@
 #include "FreeRTOS_IP.h"
 #include "FreeRTOS_Sockets.h"
 
+#include "button_publisher.h"
+#include "gpio_pins.h"
+#include "job_pool.h"
+#include "led_command.h"
+#include "led_output.h"
+#include "led_proto.h"
+#include "socket_client.h"
+#include "socket_profile.h"
+#include "static_alloc.h"
+#include "task_monitor.h"
+#include "tcp_server.h"
+
 // Task priorities.
 #define LOW_TASK_PRIORITY         (configMAX_PRIORITIES - 2)
 #define NORMAL_TASK_PRIORITY     (configMAX_PRIORITIES - 1)
@@ -24,23 +36,22 @@
 
 // Task names.
 #define TASK_NAME_LED_PTA        "led_pta"
-#define TASK_NAME_SOCKET_SRV    "socket_srv"
 #define TASK_NAME_SOCKET_CLI    "socket_cli"
-#define TASK_NAME_SET_ONOFF    "set_onoff"
-#define TASK_NAME_MONITOR_BUTTONS "monitor_buttons"
-#define TASK_NAME_PRINT_BUTTONS   "print_buttons"
-
-typedef enum { LEFT, RIGHT } Direction_t;
-
-xSocket_t l_sock_client;
 
-#define SOCKET_SRV_TOUT            1000
-#define SOCKET_SRV_BUF_SIZE        256
 #define SOCKET_SRV_PORT            3333
 
 #define SOCKET_CLI_PORT            3333
 
-#define BUT_NUM         4
+// Set to 1 to measure throughput and latency of socket profiles
+#define SOCKET_PROFILE_BENCH     0
+
+// Echo server on host for socket profile test
+#define SOCKET_BENCH_PORT        3334
+
+// Kind of button messages in TX ring, slow client gets only the latest state
+#define TCP_KIND_BUTTONS        1
+
+#define BUT_PINS_MASK   ( SW_PTC9_PIN_MASK | SW_PTC10_PIN_MASK | SW_PTC11_PIN_MASK | SW_PTC12_PIN_MASK )
 #define LED_PTA_NUM     2
 #define LED_PTC_NUM        8
 #define LED_PTB_NUM        9
@@ -69,45 +80,19 @@ LED_Data ptc[ LED_PTC_NUM ] =
                 { LED_PTC8_PIN, LED_PTC8_GPIO },
         };
 
-struct CUSTOM_LED {
-    bool state;
-    uint32_t pin;
-    GPIO_Type *gpio;
-};
-
-CUSTOM_LED ptc_bool[ LED_PTC_NUM ] =
-        {
-                { false, LED_PTC0_PIN, LED_PTC0_GPIO },
-                { false, LED_PTC1_PIN, LED_PTC1_GPIO },
-                { false, LED_PTC2_PIN, LED_PTC2_GPIO },
-                { false, LED_PTC3_PIN, LED_PTC3_GPIO },
-                { false, LED_PTC4_PIN, LED_PTC4_GPIO },
-                { false, LED_PTC5_PIN, LED_PTC5_GPIO },
-                { false, LED_PTC7_PIN, LED_PTC7_GPIO },
-                { false, LED_PTC8_PIN, LED_PTC8_GPIO },
-        };
-
-struct CUSTOM_BUT {
-    bool state;
-    bool change;
-    bool released;
-    unsigned int pin;
-    GPIO_Type *gpio;
-};
-
-CUSTOM_BUT but_bool[BUT_NUM] = {
-        {false, false, false, SW_PTC9_PIN, SW_PTC9_GPIO},
-        {false, false, false, SW_PTC10_PIN, SW_PTC10_GPIO},
-        {false, false, false, SW_PTC11_PIN, SW_PTC11_GPIO},
-        {false, false, false, SW_PTC12_PIN, SW_PTC12_GPIO}
-};
+// all PTCx LEDs as one group, bit i is ptc[ i ]
+typedef PinGroup<
+        Pin< GPIOC_BASE, LED_PTC0_PIN >,
+        Pin< GPIOC_BASE, LED_PTC1_PIN >,
+        Pin< GPIOC_BASE, LED_PTC2_PIN >,
+        Pin< GPIOC_BASE, LED_PTC3_PIN >,
+        Pin< GPIOC_BASE, LED_PTC4_PIN >,
+        Pin< GPIOC_BASE, LED_PTC5_PIN >,
+        Pin< GPIOC_BASE, LED_PTC7_PIN >,
+        Pin< GPIOC_BASE, LED_PTC8_PIN > > LED_PTC_Group;
 
 void task_led_pta_blink( void *t_arg );
-void task_socket_srv( void *tp_arg );
 void task_socket_cli( void *tp_arg );
-void task_set_onoff( void *tp_arg );
-void task_monitor_buttons(void *tp_arg);
-void task_print_buttons(void *tp_arg);
 void msg(); // Declare the msg function prototype
 
 BaseType_t xApplicationGetRandomNumber( uint32_t * tp_pul_number ) { return uxRand(); }
@@ -134,211 +119,185 @@ void task_led_pta_blink( void *t_arg )
     }
 }
 
-bool parse_led_command(const char* input, Direction_t* dir, int* num) {
-
-    char led_str[] = "LED";
-    int i = 0;
-
-
-    while (input[i] == ' ') i++;
-
-
-    int j = 0;
-    while (led_str[j] != '\0') {
-        if (input[i] != led_str[j]) {
-            return false;
-        }
-        i++;
-        j++;
-    }
-
-
-    while (input[i] == ' ') i++;
-
-
-    if (input[i] == 'L' || input[i] == 'l') {
-        *dir = LEFT;
-    } else if (input[i] == 'R' || input[i] == 'r') {
-        *dir = RIGHT;
-    } else {
-        return false;
-    }
-    i++;
+// Set all LEDs, bit i is ptc[ i ], animation is stopped
+void set_led_mask(uint32_t mask) {
+    LedOutputPublish(mask);
+}
 
-    while (input[i] == ' ') i++;
+// Start animation of t_len masks
+void set_led_animation(const uint8_t *tp_frames, uint32_t tp_len, uint32_t tp_step_ms) {
+    LedOutputAnimate(tp_frames, tp_len, tp_step_ms);
+}
 
-    if (input[i] >= '0' && input[i] <= '9') {
-        *num = 0;
-        while (input[i] >= '0' && input[i] <= '9') {
-            *num = (*num) * 10 + (input[i] - '0');
-            i++;
-        }
+// Set LEDs from left or right side
+void apply_led_command(Direction_t direction, int num_leds) {
+    if (num_leds >= 0 && num_leds <= LED_PTC_NUM) {
+        set_led_mask(led_command_mask(direction, num_leds, LED_PTC_NUM));
     } else {
-        return false;
+        PRINTF("Invalid number of LEDs: %d\n", num_leds);
     }
-
-    return true;
 }
 
-void task_socket_srv( void *tp_arg )
+// State of every server client, slot of TcpConnection
+struct SrvClient
 {
-    PRINTF( "Task socket server started.\r\n" );
-    TickType_t l_receive_tout = 25000 / portTICK_PERIOD_MS;
-
-    int l_port = ( int ) tp_arg;
-    struct freertos_sockaddr l_srv_address;
-
-    l_srv_address.sin_port = FreeRTOS_htons( l_port );
-    l_srv_address.sin_addr = FreeRTOS_inet_addr_quick( 0, 0, 0, 0 );
-
-    xSocket_t l_sock_listen;
-    xWinProperties_t l_win_props;
-    struct freertos_sockaddr from;
-    socklen_t fromSize = sizeof from;
-    BaseType_t l_bind_result;
-    int8_t l_rx_buf[ SOCKET_SRV_BUF_SIZE + 1 ];
-
-    l_sock_listen = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
-    configASSERT( l_sock_listen != FREERTOS_INVALID_SOCKET );
-
-    l_bind_result = FreeRTOS_bind( l_sock_listen, &l_srv_address, sizeof l_srv_address );
-    configASSERT( l_bind_result == 0 );
-
-    FreeRTOS_setsockopt( l_sock_listen, 0, FREERTOS_SO_RCVTIMEO, &l_receive_tout, sizeof( l_receive_tout ) );
-    FreeRTOS_setsockopt( l_sock_listen, 0, FREERTOS_SO_SNDTIMEO, &l_receive_tout, sizeof( l_receive_tout ) );
-
-    memset( &l_win_props, '\0', sizeof l_win_props );
-
-    l_win_props.lTxBufSize   = SOCKET_SRV_BUF_SIZE;
-    l_win_props.lTxWinSize   = 2;
-    l_win_props.lRxBufSize   = SOCKET_SRV_BUF_SIZE;
-    l_win_props.lRxWinSize   = 2;
-
-    FreeRTOS_setsockopt( l_sock_listen, 0, FREERTOS_SO_WIN_PROPERTIES, ( void * ) &l_win_props, sizeof( l_win_props ) );
+    uint32_t m_id;              // m_id of connection, state is reset for new one
+    bool m_binary;              // LP_MODE_LINE received
+    uint16_t m_subscribe;       // LP_SUB_* of binary client
+    LedLineParser m_parser;
+    LpDecoder m_decoder;
+};
 
-    FreeRTOS_listen( l_sock_listen, 2 );
+SrvClient g_srv_client[ TCP_SERVER_CLIENTS ];
 
-    PRINTF( "Socket server started, listening on port %u.\r\n", FreeRTOS_ntohs( l_srv_address.sin_port ) );
+SrvClient *srv_client( TcpConnection *tp_conn )
+{
+    SrvClient *l_client = &g_srv_client[ tp_conn->m_slot ];
 
-    for( ;; )
+    if ( l_client->m_id != tp_conn->m_id )
     {
-        uint32_t l_reply_count = 0;
-
-        do {
-            l_sock_client = FreeRTOS_accept( l_sock_listen, &from, &fromSize );
-            vTaskDelay( SOCKET_SRV_TOUT / portTICK_PERIOD_MS );
-        } while ( l_sock_client == FREERTOS_INVALID_SOCKET );
-
-        if ( l_sock_client == FREERTOS_INVALID_SOCKET )
-        {
-            PRINTF( "Invalid socket from ACCEPT!\r\n" );
-            continue;
-        }
+        l_client->m_id = tp_conn->m_id;
+        l_client->m_binary = false;
+        l_client->m_subscribe = 0;
+        l_client->m_parser.reset();
+        l_client->m_decoder.reset();
+    }
+    return l_client;
+}
 
-        vTaskDelay( 100 / portTICK_PERIOD_MS );
+// Frames of binary protocol, replies only on error
+void socket_srv_frames( TcpConnection *tp_conn, SrvClient *tp_client, const uint8_t *tp_data, size_t tp_len )
+{
+    uint8_t l_tx_buf[ LP_HEADER_SIZE * 8 ];
+    size_t l_tx_len = 0;
 
-        for ( l_reply_count = 0; pdTRUE; l_reply_count++ )
+    tp_client->m_decoder.feed( tp_data, tp_len,
+        [&]( const LpFrame &tp_frame )
         {
-            BaseType_t l_len;
+            bool l_ok = true;
 
-            l_len = FreeRTOS_recv(    l_sock_client, l_rx_buf, SOCKET_SRV_BUF_SIZE, 0 );
+            switch ( tp_frame.m_op )
+            {
+            case LP_OP_SET_MASK:
+                set_led_mask( tp_frame.m_arg );
+                break;
+            case LP_OP_ANIMATE:
+                if ( tp_frame.m_len )
+                    set_led_animation( tp_frame.m_payload, tp_frame.m_len, tp_frame.m_arg );
+                else
+                    l_ok = false;
+                break;
+            case LP_OP_SUBSCRIBE:
+                tp_client->m_subscribe = tp_frame.m_arg;
+                break;
+            default:
+                l_ok = false;
+                break;
+            }
 
-            if( l_len > 0 )
+            if ( !l_ok )
             {
-                l_rx_buf[ l_len ] = '\0';
-
-                PRINTF( "Received: %s\r\n", l_rx_buf );
-
-                Direction_t direction;
-                int num_leds;
-
-                if (parse_led_command((char *)l_rx_buf, &direction, &num_leds)) {
-                    PRINTF("Parsed command: Direction=%s, Number=%d\r\n", direction == LEFT ? "LEFT" : "RIGHT", num_leds);
-
-                    if (num_leds >= 0 && num_leds <= LED_PTC_NUM) {
-                        if (direction == LEFT) {
-                            for (int i = 0; i < num_leds; i++) {
-                                ptc_bool[i].state = true;
-                                PRINTF("LED PTC%d ON\n", i);
-                            }
-                            for (int i = num_leds; i < LED_PTC_NUM; i++) {
-                                ptc_bool[i].state = false;
-                            }
-                        } else if (direction == RIGHT) {
-                            for (int i = 0; i < num_leds; i++) {
-                                ptc_bool[LED_PTC_NUM - 1 - i].state = true;
-                                PRINTF("LED PTC%d ON\n", LED_PTC_NUM - 1 - i);
-                            }
-                            for (int i = 0; i < LED_PTC_NUM - num_leds; i++) {
-                                ptc_bool[i].state = false;
-                            }
-                        }
-                    } else {
-                        PRINTF("Invalid number of LEDs: %d\n", num_leds);
-                    }
-                } else {
-                    PRINTF("Invalid command format\n");
+                if ( l_tx_len + LP_HEADER_SIZE > sizeof( l_tx_buf ) )
+                {
+                    TcpServerSend( tp_conn, l_tx_buf, l_tx_len );
+                    l_tx_len = 0;
                 }
+                uint16_t l_op = tp_frame.m_op == LP_OP_ERROR ? tp_frame.m_arg : tp_frame.m_op;
+                l_tx_len += lp_encode( l_tx_buf + l_tx_len, LP_OP_ERROR, l_op );
+            }
+        } );
 
-                l_len = FreeRTOS_send( l_sock_client, ( void * ) l_rx_buf, strlen((char*)l_rx_buf), 0 );
+    if ( l_tx_len )
+        TcpServerSend( tp_conn, l_tx_buf, l_tx_len );
+}
 
-                PRINTF( "Server forwarded %d bytes.\r\n", l_len );
-            }
-            if ( l_len < 0 )
-            {
-                // Error occurred
-                PRINTF( "FreeRTOS_recv returned error: %ld.\r\n", l_len );
-                break;
-            }
-            if ( l_len == 0 )
+// Handler of TCP server, data may contain more commands or part of one.
+// All complete text commands are executed and echoed back, every message
+// in TX ring holds only whole lines.
+void socket_srv_command( TcpConnection *tp_conn, const uint8_t *tp_data, size_t tp_len )
+{
+    SrvClient *l_client = srv_client( tp_conn );
+    char l_tx_buf[ TCP_SERVER_TX_MSG_SIZE ];
+    size_t l_tx_len = 0;
+    uint32_t l_cmds = 0, l_invalid = 0;
+
+    if ( l_client->m_binary )
+    {
+        socket_srv_frames( tp_conn, l_client, tp_data, tp_len );
+        return;
+    }
+
+    size_t l_used = l_client->m_parser.feed( tp_data, tp_len,
+        [&]( const char *tp_line, uint32_t tp_line_len, bool tp_ok, Direction_t tp_dir, int tp_num )
+        {
+            l_cmds++;
+
+            // switch to binary protocol after this line
+            if ( tp_line_len == strlen( LP_MODE_LINE ) && !strncmp( tp_line, LP_MODE_LINE, tp_line_len ) )
+                l_client->m_binary = true;
+            else if ( tp_ok )
+                apply_led_command( tp_dir, tp_num );
+            else
+                l_invalid++;
+
+            // reply is full, send it and continue
+            if ( l_tx_len + tp_line_len + 1 > sizeof( l_tx_buf ) )
             {
-                PRINTF( "Recv timeout.\r\n" );
-                break;
+                TcpServerSend( tp_conn, l_tx_buf, l_tx_len );
+                l_tx_len = 0;
             }
-        }
-        PRINTF( "Socket server replied %d times.\r\n", l_reply_count );
+            memcpy( l_tx_buf + l_tx_len, tp_line, tp_line_len );
+            l_tx_len += tp_line_len;
+            l_tx_buf[ l_tx_len++ ] = '\n';
 
+            return !l_client->m_binary;
+        } );
 
-        vTaskDelay( SOCKET_SRV_TOUT / portTICK_PERIOD_MS );
+    if ( l_tx_len )
+        TcpServerSend( tp_conn, l_tx_buf, l_tx_len );
 
+    PRINTF( "Client %u: %u commands, %u invalid, %u bytes pending.\r\n",
+            tp_conn->m_id, l_cmds, l_invalid, l_client->m_parser.pending() );
 
-        FreeRTOS_closesocket( l_sock_client );
-        l_sock_client = FREERTOS_INVALID_SOCKET;
+    // frames may follow in the same segment
+    if ( l_client->m_binary )
+    {
+        PRINTF( "Client %u uses binary protocol.\r\n", tp_conn->m_id );
+        if ( l_used < tp_len )
+            socket_srv_frames( tp_conn, l_client, tp_data + l_used, tp_len - l_used );
     }
 }
 
-void task_socket_cli(void *tp_arg) {
-    PRINTF("Task socket client started.\r\n");
-
-    vTaskDelay(500 / portTICK_PERIOD_MS);
-
-    Socket_t l_sock_server = FreeRTOS_socket(FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP);
-    struct freertos_sockaddr *lp_sever_addr = (struct freertos_sockaddr *)tp_arg;
-    BaseType_t l_res = FreeRTOS_connect(l_sock_server, lp_sever_addr, sizeof(struct freertos_sockaddr));
+// Broadcast handler of TCP server, ButtonSnapshot for every client
+void socket_srv_buttons( TcpConnection *tp_conn, const uint8_t *tp_data, size_t tp_len )
+{
+    SrvClient *l_client = srv_client( tp_conn );
+    const ButtonSnapshot *l_snap = ( const ButtonSnapshot * ) tp_data;
 
-    if (l_res == 0) {
-        PRINTF("Connected to server.\r\n");
+    if ( !l_client->m_binary )
+        TcpServerSend( tp_conn, l_snap->m_text, l_snap->m_text_len, TCP_KIND_BUTTONS );
+    else if ( l_client->m_subscribe & LP_SUB_BUTTONS )
+        TcpServerSend( tp_conn, l_snap->m_frame, sizeof( l_snap->m_frame ), TCP_KIND_BUTTONS );
+}
 
-        l_sock_client = l_sock_server;
+// Sends LED sequence forever, socket client keeps connection
+void task_socket_cli(void *tp_arg) {
+    PRINTF("Task socket client started.\r\n");
 
-        while (1) {
-            msg();
-        }
-    } else {
-        PRINTF("Unable to connect to server!\r\n");
+    while (1) {
+        msg();
     }
-
-    FreeRTOS_closesocket(l_sock_server);
-    vTaskDelete(NULL);
 }
 
 // Callback from TCP stack - interface state changed
 void vApplicationIPNetworkEventHook( eIPCallbackEvent_t t_network_event )
 {
     static BaseType_t s_task_already_created = pdFALSE;
-    static struct freertos_sockaddr s_server_addr;
-    s_server_addr.sin_port = FreeRTOS_htons( SOCKET_CLI_PORT );
-    s_server_addr.sin_addr = FreeRTOS_inet_addr_quick( 10, 0, 0, 1 );
+#if SOCKET_PROFILE_BENCH
+    static struct freertos_sockaddr s_bench_addr;
+    s_bench_addr.sin_port = FreeRTOS_htons( SOCKET_BENCH_PORT );
+    s_bench_addr.sin_addr = FreeRTOS_inet_addr_quick( 10, 0, 0, 1 );
+#endif
 
     // Handle network up event
     if ( t_network_event == eNetworkUp )
@@ -347,35 +306,23 @@ void vApplicationIPNetworkEventHook( eIPCallbackEvent_t t_network_event )
         // Create the tasks that use the TCP/IP stack if they have not already been created.
         if ( s_task_already_created == pdFALSE )
         {
-            // Create socket server task
-            if ( xTaskCreate( task_socket_srv, TASK_NAME_SOCKET_SRV, configMINIMAL_STACK_SIZE + 1024,
-                              ( void * ) SOCKET_SRV_PORT, configMAX_PRIORITIES - 1, NULL ) != pdPASS )
-            {
-                PRINTF( "Unable to create task %s.\r\n", TASK_NAME_SOCKET_SRV );
-            }
+            // Create socket server task, it serves TCP_SERVER_CLIENTS clients
+            TcpServerSetBroadcastHandler( socket_srv_buttons );
+            TcpServerInit( SOCKET_SRV_PORT, socket_srv_command, configMAX_PRIORITIES - 1 );
 
-            // Optionally, create socket client task
-            /*
-            if ( xTaskCreate( task_socket_cli, TASK_NAME_SOCKET_CLI, configMINIMAL_STACK_SIZE + 1024,
-                    &s_server_addr, configMAX_PRIORITIES - 1, NULL ) != pdPASS )
-            {
-                PRINTF( "Unable to create task %s.\r\n", TASK_NAME_SOCKET_CLI );
-            }
-            */
+#if SOCKET_PROFILE_BENCH
+            SocketProfileBenchInit( &s_bench_addr, LOW_TASK_PRIORITY );
+#endif
 
             s_task_already_created = pdTRUE;
         }
     }
 }
 
-void task_set_onoff( void *tp_arg ){
-    while(1) {
-        for(int i = 0; i < LED_PTC_NUM; i++) {
-            GPIO_PinWrite( ptc_bool[ i ].gpio, ptc_bool[ i ].pin, ptc_bool[i].state );
-        }
-
-        vTaskDelay( 5 / portTICK_PERIOD_MS );
-    }
+// Output stage writes only changed LEDs
+void led_ptc_update( uint32_t t_old, uint32_t t_new )
+{
+    LED_PTC_Group::update( t_old, t_new );
 }
 
 void msg() {
@@ -387,84 +334,72 @@ void msg() {
     };
 
     for (int i = 0; i < 4; i++) {
-        if (l_sock_client != FREERTOS_INVALID_SOCKET) {
-            FreeRTOS_send(l_sock_client, (void *)commands[i], strlen(commands[i]) + 1, 0);
-            vTaskDelay(1000 / portTICK_PERIOD_MS);
-        } else {
-            PRINTF("Socket client is invalid.\r\n");
-            break;
+        // queued even when disconnected, sent after reconnect
+        if (!SocketClientSend(commands[i], strlen(commands[i]))) {
+            PRINTF("Socket client is full, command dropped.\r\n");
         }
+        vTaskDelay(1000 / portTICK_PERIOD_MS);
     }
 }
 
-void task_led_sequence(void *tp_arg) {
+// Job of worker pool, sends LED commands with 1 s delays
+void job_led_sequence(void *tp_arg) {
     msg();
-    vTaskDelete(NULL);
 }
 
-void task_monitor_buttons(void *tp_arg) {
-    for (int i = 0; i < BUT_NUM; i++) {
-        but_bool[i].change = false;
-        but_bool[i].released = true;
-        but_bool[i].state = false;
-    }
-
-    while (1) {
-        for (int i = 0; i < BUT_NUM; i++) {
-            bool state = GPIO_PinRead(but_bool[i].gpio, but_bool[i].pin);
-            bool prev_state = but_bool[i].state;
-
-            but_bool[i].state = (state == 0);
-
-            if (but_bool[i].state != prev_state) {
-                but_bool[i].change = true;
-                but_bool[i].released = !but_bool[i].state;
-
-                if (i == 0 && but_bool[i].state) {
-                    if (xTaskCreate(
-                            task_led_sequence,
-                            "led_sequence",
-                            configMINIMAL_STACK_SIZE + 100,
-                            NULL,
-                            NORMAL_TASK_PRIORITY,
-                            NULL) != pdPASS) {
-                        PRINTF("Unable to create task 'led_sequence'.\r\n");
-                    }
-                }
-            } else {
-                but_bool[i].change = false;
-            }
+// Change of buttons from button publisher
+void buttons_changed(const ButtonSnapshot *tp_snap) {
+    // PTC9 pressed
+    if (tp_snap->m_changed & tp_snap->m_pressed & 1) {
+        // previous sequence may still run, press is rejected when pool is full
+        if (!JobPoolSubmit(job_led_sequence, NULL)) {
+            PRINTF("Job pool is full, press ignored.\r\n");
         }
+    }
 
-        vTaskDelay(1 / portTICK_PERIOD_MS);
+    // publisher must not wait for server
+    if (SocketClientSend(tp_snap->m_text, tp_snap->m_text_len - 1)) {
+        PRINTF("Sent Button States: %s", tp_snap->m_text);
+    } else {
+        PRINTF("Socket client is full, button states dropped.\r\n");
     }
+    // and to all clients of socket server, text or binary
+    TcpServerBroadcast(tp_snap, sizeof(*tp_snap));
 }
 
-void task_print_buttons(void *tp_arg) {
-    bool enter = false;
-    char msg[64];
+// Compare CPU cycles of GPIO_PinWrite loop and LED_PTC_Group
+void benchmark_gpio_pins() {
+    const int l_rounds = 100;
+    uint32_t l_start, l_loop, l_group, l_bitband;
 
-    while (true) {
-        strcpy(msg, "BTN ");
-        for (int i = 0; i < BUT_NUM; ++i) {
-            sprintf(msg + strlen(msg), "%d", but_bool[i].state ? 1 : 0);
-            if (!enter && but_bool[i].change) {
-                enter = true;
-            }
-            but_bool[i].change = false;
-        }
-        strcat(msg, "\n");
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 
-        if (enter) {
-            if(l_sock_client != FREERTOS_INVALID_SOCKET){
-                FreeRTOS_send(l_sock_client, (void *)msg, strlen(msg) + 1, 0);
-                PRINTF("Sent Button States: %s", msg);
-            }
-            enter = false;
+    l_start = DWT->CYCCNT;
+    for (int r = 0; r < l_rounds; r++) {
+        for (int i = 0; i < LED_PTC_NUM; i++) {
+            GPIO_PinWrite( ptc[ i ].gpio, ptc[ i ].pin, r & 1 );
         }
+    }
+    l_loop = DWT->CYCCNT - l_start;
 
-        vTaskDelay(1 / portTICK_PERIOD_MS);
+    l_start = DWT->CYCCNT;
+    for (int r = 0; r < l_rounds; r++) {
+        LED_PTC_Group::write( ( r & 1 ) ? 0xFF : 0 );
     }
+    l_group = DWT->CYCCNT - l_start;
+
+    l_start = DWT->CYCCNT;
+    for (int r = 0; r < l_rounds; r++) {
+        Pin< GPIOC_BASE, LED_PTC0_PIN >::write_atomic( r & 1 );
+    }
+    l_bitband = DWT->CYCCNT - l_start;
+
+    LED_PTC_Group::clear_all();
+
+    PRINTF("GPIO_PinWrite x%d: %u cycles, LED_PTC_Group: %u cycles, bit-band pin: %u cycles.\r\n",
+           LED_PTC_NUM, l_loop / l_rounds, l_group / l_rounds, l_bitband / l_rounds);
 }
 
 int main(void) {
@@ -478,10 +413,10 @@ int main(void) {
 
     SYSMPU_Enable(SYSMPU, false);
 
-    PRINTF("FreeRTOS+TCP with Left/Right LED
-
     PRINTF("FreeRTOS+TCP with Left/Right LED Control started.\r\n");
 
+    benchmark_gpio_pins();
+
     // SET CORRECTLY MAC ADDRESS FOR USAGE IN LAB!
     //
     // Computer in lab use IP address 158.196.XXX.YYY.
@@ -497,7 +432,7 @@ int main(void) {
     FreeRTOS_IPInit(ucIPAddress, ucIPMask, ucIPGW, NULL, ucMAC);
 
     // Create existing tasks
-    if (xTaskCreate(
+    if (APP_TASK_CREATE(
             task_led_pta_blink,
             TASK_NAME_LED_PTA,
             configMINIMAL_STACK_SIZE + 100,
@@ -508,54 +443,31 @@ int main(void) {
         PRINTF("Unable to create task '%s'.\r\n", TASK_NAME_LED_PTA );
     }
 
-    if (xTaskCreate(
-            task_set_onoff,
-            TASK_NAME_SET_ONOFF,
-            configMINIMAL_STACK_SIZE + 100,
-            NULL,
-            NORMAL_TASK_PRIORITY,
-            NULL) != pdPASS )
-    {
-        PRINTF("Unable to create task '%s'.\r\n", TASK_NAME_SET_ONOFF );
-    }
+    LedOutputInit( led_ptc_update, NORMAL_TASK_PRIORITY );
 
-    if (xTaskCreate(
-            task_monitor_buttons,
-            TASK_NAME_MONITOR_BUTTONS,
-            configMINIMAL_STACK_SIZE + 100,
-            NULL,
-            NORMAL_TASK_PRIORITY,
-            NULL) != pdPASS )
-    {
-        PRINTF("Unable to create task '%s'.\r\n", TASK_NAME_MONITOR_BUTTONS );
-    }
-
-    if (xTaskCreate(
-            task_print_buttons,
-            TASK_NAME_PRINT_BUTTONS,
-            configMINIMAL_STACK_SIZE + 100,
-            NULL,
-            NORMAL_TASK_PRIORITY,
-            NULL) != pdPASS )
-    {
-        PRINTF("Unable to create task '%s'.\r\n", TASK_NAME_PRINT_BUTTONS );
-    }
+    JobPoolInit( NORMAL_TASK_PRIORITY );
+    ButtonPublisherInit( BUT_PINS_MASK, buttons_changed, NORMAL_TASK_PRIORITY );
 
     static struct freertos_sockaddr s_server_addr;
-    s_server_addr.sin_port = FreeRTOS_htons(3333);
+    s_server_addr.sin_port = FreeRTOS_htons(SOCKET_CLI_PORT);
     s_server_addr.sin_addr = FreeRTOS_inet_addr_quick(158, 196, 142, 100);
 
-    if (xTaskCreate(
+    // Client reconnects whenever connection is lost
+    SocketClientInit(&s_server_addr, NORMAL_TASK_PRIORITY);
+
+    if (APP_TASK_CREATE(
             task_socket_cli,
             TASK_NAME_SOCKET_CLI,
-            configMINIMAL_STACK_SIZE + 1024,
-            &s_server_addr,
+            configMINIMAL_STACK_SIZE + 100,
+            NULL,
             configMAX_PRIORITIES - 1,
             NULL) != pdPASS )
     {
         PRINTF("Unable to create task '%s'.\r\n", TASK_NAME_SOCKET_CLI );
     }
 
+    TaskMonitorInit( TASK_MONITOR_PERIOD_MS, tskIDLE_PRIORITY + 1 );
+
     vTaskStartScheduler();
 
     while (1);
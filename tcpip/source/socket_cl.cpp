@@ -28,69 +28,1831 @@
 #include <unistd.h>
 #include <errno.h>
 #include <netdb.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <atomic>
+#include <sys/mman.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/timerfd.h>
+
+#include "led_command.h"
+#include "led_proto.h"
 
 #define STR_CLOSE               "close"
+#define STR_BUTTONS             "BTN "
+
+#define LED_NUM                 8
+
+//***************************************************************************
+// log messages
+
+#define LOG_ERROR               0       // errors
+#define LOG_INFO                1       // information and notifications
+#define LOG_DEBUG               2       // debug messages
+
+// debug flag
+int g_debug = LOG_INFO;
+
+void log_msg( int t_log_level, const char *t_form, ... )
+{
+    const char *out_fmt[] = {
+            "ERR: (%d-%s) %s\n",
+            "INF: %s\n",
+            "DEB: %s\n" };
+
+    if ( t_log_level && t_log_level > g_debug ) return;
+
+    char l_buf[ 1024 ];
+    va_list l_arg;
+    va_start( l_arg, t_form );
+    vsprintf( l_buf, t_form, l_arg );
+    va_end( l_arg );
+
+    switch ( t_log_level )
+    {
+        case LOG_INFO:
+        case LOG_DEBUG:
+            fprintf( stdout, out_fmt[ t_log_level ], l_buf );
+            break;
+
+        case LOG_ERROR:
+            fprintf( stderr, out_fmt[ t_log_level ], errno, strerror( errno ), l_buf );
+            break;
+    }
+}
+
+//***************************************************************************
+// help
+
+void help( int t_narg, char **t_args )
+{
+    if ( t_narg <= 1 || !strcmp( t_args[ 1 ], "-h" ) )
+    {
+        printf(
+                "\n"
+                "  Socket client example.\n"
+                "\n"
+                "  Use: %s [-h -d -b] [--load n ... | --latency n ... | --replay file ...] ip_or_name port_number\n"
+                "       %s [-d] --fleet hosts_file\n"
+                "\n"
+                "    -d  debug mode \n"
+                "    -b  binary protocol, commands from stdin:\n"
+                "          LED L|R n            LEDs from left or right\n"
+                "          MASK m               LEDs by bit mask\n"
+                "          ANIM ms m1 m2 ...    repeat masks, step in ms\n"
+                "          SUB m                subscribe events, 1 buttons\n"
+                "          FLOOD n              send n masks at once, print rate\n"
+                "    -h  this help\n"
+                "\n"
+                "    --load n      open n connections and send LED commands, report rate\n"
+                "    --rate r      commands/s of all connections, 0 no limit (1000)\n"
+                "    --time s      duration of load in seconds (10)\n"
+                "    --window w    commands without echo per connection (4), at most 64,\n"
+                "                  command without echo in 2 s is lost\n"
+                "    --mix l:r:i   weights of LED L, LED R and invalid command (1:1:0)\n"
+                "\n"
+                "    --latency n   send n commands (0 until Ctrl+C), histogram of echo time\n"
+                "    --interval ms time between commands, 0 next one after echo (0),\n"
+                "                  latency is measured from scheduled time of command,\n"
+                "                  command without echo in 2 s is lost\n"
+                "    --report s    period of percentiles (1)\n"
+                "    --csv file    write histogram at exit\n"
+                "    --nodelay     disable Nagle algorithm (TCP_NODELAY)\n"
+                "\n"
+                "    --replay file send lines 'time_offset_us command' at their time\n"
+                "    --speed f     2 twice faster, 0 as fast as possible (1)\n"
+                "    --out file    CSV with send and echo time of every command (stdout)\n"
+                "\n"
+                "    --record file append button states with time to binary file,\n"
+                "                  written every second and at exit, also by Ctrl+C\n"
+                "    --dump file   print recorded file and exit, no host is needed\n"
+                "\n"
+                "    --fleet file  connect all boards from lines 'ip_or_name port [label]',\n"
+                "                  send every line from stdin to all, print replies of boards\n"
+                "                  and skew between the fastest and slowest reply\n"
+                "\n", t_args[ 0 ], t_args[ 0 ] );
+
+        exit( 0 );
+    }
+
+    if ( !strcmp( t_args[ 1 ], "-d" ) )
+        g_debug = LOG_DEBUG;
+}
+
+//***************************************************************************
+// binary protocol
+
+// Write all data to socket
+int write_all( int t_sock, const void *t_data, size_t t_len )
+{
+    const char *l_data = ( const char * ) t_data;
+    while ( t_len )
+    {
+        int l_len = write( t_sock, l_data, t_len );
+        if ( l_len <= 0 ) return -1;
+        l_data += l_len;
+        t_len -= l_len;
+    }
+    return 0;
+}
+
+// Send LP_MODE_LINE and wait for the same reply
+int bin_negotiate( int t_sock )
+{
+    char l_line[ 64 ];
+    size_t l_len = 0;
+
+    if ( write_all( t_sock, LP_MODE_LINE "\n", strlen( LP_MODE_LINE ) + 1 ) < 0 ) return -1;
+
+    // read byte by byte, frames may follow reply
+    while ( l_len < sizeof( l_line ) - 1 )
+    {
+        if ( read( t_sock, l_line + l_len, 1 ) != 1 ) return -1;
+        if ( l_line[ l_len ] == '\n' )
+        {
+            l_line[ l_len ] = '\0';
+            if ( !strcmp( l_line, LP_MODE_LINE ) ) return 0;
+            l_len = 0;      // other line, e.g. text button state
+            continue;
+        }
+        l_len++;
+    }
+    return -1;
+}
+
+// Translate command from stdin into frames and send them
+void bin_command( int t_sock, char *t_line )
+{
+    uint8_t l_frame[ LP_HEADER_SIZE + LP_MAX_PAYLOAD ];
+    Direction_t l_dir;
+    int l_num;
+    char *l_arg;
+
+    if ( parse_led_command( t_line, &l_dir, &l_num ) )
+    {
+        size_t l_len = lp_encode( l_frame, LP_OP_SET_MASK, led_command_mask( l_dir, l_num, LED_NUM ) );
+        write_all( t_sock, l_frame, l_len );
+    }
+    else if ( !strncasecmp( t_line, "MASK", 4 ) )
+    {
+        size_t l_len = lp_encode( l_frame, LP_OP_SET_MASK, strtoul( t_line + 4, nullptr, 0 ) );
+        write_all( t_sock, l_frame, l_len );
+    }
+    else if ( !strncasecmp( t_line, "SUB", 3 ) )
+    {
+        size_t l_len = lp_encode( l_frame, LP_OP_SUBSCRIBE, strtoul( t_line + 3, nullptr, 0 ) );
+        write_all( t_sock, l_frame, l_len );
+    }
+    else if ( !strncasecmp( t_line, "ANIM", 4 ) )
+    {
+        uint8_t l_masks[ LP_MAX_PAYLOAD ];
+        uint8_t l_count = 0;
+        uint16_t l_step = strtoul( t_line + 4, &l_arg, 0 );
+
+        while ( l_count < LP_MAX_PAYLOAD )
+        {
+            char *l_end;
+            unsigned long l_mask = strtoul( l_arg, &l_end, 0 );
+            if ( l_end == l_arg ) break;
+            l_masks[ l_count++ ] = l_mask;
+            l_arg = l_end;
+        }
+        if ( !l_count )
+        {
+            log_msg( LOG_INFO, "ANIM needs at least one mask." );
+            return;
+        }
+        size_t l_len = lp_encode( l_frame, LP_OP_ANIMATE, l_step, l_masks, l_count );
+        write_all( t_sock, l_frame, l_len );
+    }
+    else if ( !strncasecmp( t_line, "FLOOD", 5 ) )
+    {
+        int l_count = atoi( t_line + 5 );
+        uint8_t l_buf[ LP_HEADER_SIZE * 256 ];
+        timeval l_start, l_stop;
+
+        gettimeofday( &l_start, nullptr );
+        for ( int i = 0; i < l_count; )
+        {
+            size_t l_len = 0;
+            for ( ; i < l_count && l_len < sizeof( l_buf ); i++ )
+                l_len += lp_encode( l_buf + l_len, LP_OP_SET_MASK, 1 << ( i % LED_NUM ) );
+            if ( write_all( t_sock, l_buf, l_len ) < 0 )
+            {
+                log_msg( LOG_ERROR, "Unable to send data to server." );
+                return;
+            }
+        }
+        gettimeofday( &l_stop, nullptr );
+
+        double l_sec = ( l_stop.tv_sec - l_start.tv_sec ) + ( l_stop.tv_usec - l_start.tv_usec ) * 1e-6;
+        log_msg( LOG_INFO, "Sent %d masks in %.3f s, %.0f masks/s.", l_count, l_sec, l_sec > 0 ? l_count / l_sec : 0.0 );
+    }
+    else if ( *t_line )
+        log_msg( LOG_INFO, "Unknown command '%s'.", t_line );
+}
+
+// Commands from stdin, line may be split between reads.
+// Returns -1 for STR_CLOSE.
+int bin_stdin( int t_sock, const char *t_data, int t_len )
+{
+    static char s_line[ 256 ];
+    static int s_len = 0;
+
+    for ( int i = 0; i < t_len; i++ )
+    {
+        if ( t_data[ i ] != '\n' && t_data[ i ] != '\r' )
+        {
+            if ( s_len < ( int ) sizeof( s_line ) - 1 ) s_line[ s_len++ ] = t_data[ i ];
+            continue;
+        }
+
+        s_line[ s_len ] = '\0';
+        s_len = 0;
+        if ( !strncasecmp( s_line, STR_CLOSE, strlen( STR_CLOSE ) ) ) return -1;
+        bin_command( t_sock, s_line );
+    }
+    return 0;
+}
+
+// Print one frame from server, frame is complete in receive ring
+void bin_print( const uint8_t *t_frame )
+{
+    uint16_t l_arg = lp_frame_arg( t_frame );
+
+    if ( t_frame[ 0 ] == LP_OP_BUTTONS )
+    {
+        char l_pressed[ 9 ], l_changed[ 9 ];
+        for ( int i = 0; i < 8; i++ )
+        {
+            l_pressed[ i ] = ( l_arg >> i ) & 1 ? '1' : '0';
+            l_changed[ i ] = ( l_arg >> ( 8 + i ) ) & 1 ? '1' : '0';
+        }
+        l_pressed[ 8 ] = l_changed[ 8 ] = '\0';
+        printf( "BTN %s changed %s\n", l_pressed, l_changed );
+    }
+    else if ( t_frame[ 0 ] == LP_OP_ERROR )
+        printf( "ERR opcode 0x%02X refused\n", l_arg );
+    else
+        printf( "Frame 0x%02X len %d arg 0x%04X\n", t_frame[ 0 ], t_frame[ 1 ], l_arg );
+    fflush( stdout );
+}
+
+//***************************************************************************
+// lines from server
+
+enum LineKind { LINE_EMPTY, LINE_BUTTONS, LINE_REPLY };
+
+// Server sends button state "BTN xxxx\n" with its terminating zero, so next
+// line starts with '\0'. Leading zeros and '\r' are skipped, t_line and t_len
+// are moved to the rest of line.
+LineKind line_kind( const char *&t_line, int &t_len )
+{
+    while ( t_len && ( *t_line == '\0' || *t_line == '\r' ) )
+    {
+        t_line++;
+        t_len--;
+    }
+    if ( !t_len ) return LINE_EMPTY;
+    if ( t_len >= ( int ) strlen( STR_BUTTONS ) && !memcmp( t_line, STR_BUTTONS, strlen( STR_BUTTONS ) ) )
+        return LINE_BUTTONS;
+    return LINE_REPLY;
+}
+
+//***************************************************************************
+// load generator, many connections in one epoll loop
+
+#define LOAD_WINDOW_MAX         64      // limit of --window
+#define LOAD_ECHO_TOUT          2.0     // s, command without echo is lost
+
+struct LoadConfig
+{
+    int m_conns = 100;
+    double m_rate = 1000;       // commands/s of all connections, 0 no limit
+    double m_time = 10;         // seconds
+    int m_window = 4;           // commands without echo per connection
+    int m_mix[ 3 ] = { 1, 1, 0 };   // weights of LED L, LED R, invalid line
+};
+
+enum LoadState { LOAD_CONNECTING, LOAD_OPEN, LOAD_CLOSED };
+
+struct LoadConn
+{
+    int m_fd;
+    LoadState m_state;
+    double m_start;             // connect() called
+    int m_pending;              // commands without echo
+    int m_pend_head;            // the oldest in m_sent_at
+    double m_sent_at[ LOAD_WINDOW_MAX ];    // send times of commands without echo
+    char m_in[ 64 ];            // incomplete line
+    int m_in_len;
+    char m_out[ 64 ];           // unsent part of command
+    int m_out_len;
+};
+
+struct LoadStats
+{
+    long m_sent, m_echoed, m_lost, m_connected, m_failed, m_closed, m_errors, m_stalls;
+    double m_setup_sum, m_setup_min, m_setup_max, m_setup_last;
+};
+
+double now_sec()
+{
+    timespec l_ts;
+    clock_gettime( CLOCK_MONOTONIC, &l_ts );
+    return l_ts.tv_sec + l_ts.tv_nsec * 1e-9;
+}
+
+// Parse "--mix l:r:invalid"
+void load_mix( LoadConfig &t_cfg, const char *t_arg )
+{
+    if ( sscanf( t_arg, "%d:%d:%d", &t_cfg.m_mix[ 0 ], &t_cfg.m_mix[ 1 ], &t_cfg.m_mix[ 2 ] ) != 3 ||
+         t_cfg.m_mix[ 0 ] + t_cfg.m_mix[ 1 ] + t_cfg.m_mix[ 2 ] <= 0 )
+    {
+        log_msg( LOG_INFO, "Wrong mix '%s', use e.g. 2:2:1.", t_arg );
+        exit( 1 );
+    }
+}
+
+void load_close( int t_epoll, LoadConn &t_conn )
+{
+    epoll_ctl( t_epoll, EPOLL_CTL_DEL, t_conn.m_fd, nullptr );
+    close( t_conn.m_fd );
+    t_conn.m_state = LOAD_CLOSED;
+}
+
+// Write rest of command, EPOLLOUT is needed only when socket is full
+void load_flush( int t_epoll, LoadConn &t_conn, uint32_t t_index, LoadStats &t_stats )
+{
+    int l_len = write( t_conn.m_fd, t_conn.m_out, t_conn.m_out_len );
+    if ( l_len < 0 && errno != EAGAIN )
+    {
+        t_stats.m_errors++;
+        load_close( t_epoll, t_conn );
+        return;
+    }
+    if ( l_len > 0 )
+    {
+        t_conn.m_out_len -= l_len;
+        memmove( t_conn.m_out, t_conn.m_out + l_len, t_conn.m_out_len );
+    }
+    if ( t_conn.m_out_len )
+    {
+        t_stats.m_stalls++;
+        epoll_event l_ev = { EPOLLIN | EPOLLOUT | EPOLLRDHUP, { .u32 = t_index } };
+        epoll_ctl( t_epoll, EPOLL_CTL_MOD, t_conn.m_fd, &l_ev );
+    }
+}
+
+// Random command by weights of mix
+int load_command( const LoadConfig &t_cfg, char *t_buf )
+{
+    int l_pick = rand() % ( t_cfg.m_mix[ 0 ] + t_cfg.m_mix[ 1 ] + t_cfg.m_mix[ 2 ] );
+
+    if ( l_pick < t_cfg.m_mix[ 0 ] )
+        return sprintf( t_buf, "LED L %d\n", rand() % ( LED_NUM + 1 ) );
+    if ( l_pick < t_cfg.m_mix[ 0 ] + t_cfg.m_mix[ 1 ] )
+        return sprintf( t_buf, "LED R %d\n", rand() % ( LED_NUM + 1 ) );
+    return sprintf( t_buf, "LED X\n" );
+}
+
+// Count echoed lines, button states broadcast by server are not echoes
+void load_read( int t_epoll, LoadConn &t_conn, LoadStats &t_stats )
+{
+    char l_buf[ 1024 ];
+
+    while ( 1 )
+    {
+        int l_len = read( t_conn.m_fd, l_buf, sizeof( l_buf ) );
+        if ( l_len < 0 && errno == EAGAIN ) return;
+        if ( l_len <= 0 )
+        {
+            if ( l_len < 0 ) t_stats.m_errors++;
+            else t_stats.m_closed++;
+            load_close( t_epoll, t_conn );
+            return;
+        }
+
+        for ( int i = 0; i < l_len; i++ )
+        {
+            if ( l_buf[ i ] != '\n' )
+            {
+                if ( t_conn.m_in_len < ( int ) sizeof( t_conn.m_in ) ) t_conn.m_in[ t_conn.m_in_len++ ] = l_buf[ i ];
+                continue;
+            }
+            const char *l_line = t_conn.m_in;
+            if ( line_kind( l_line, t_conn.m_in_len ) == LINE_REPLY )
+            {
+                t_stats.m_echoed++;
+                if ( t_conn.m_pending )
+                {
+                    t_conn.m_pend_head = ( t_conn.m_pend_head + 1 ) % LOAD_WINDOW_MAX;
+                    t_conn.m_pending--;
+                }
+            }
+            t_conn.m_in_len = 0;
+        }
+    }
+}
+
+// Server may drop echoes when overloaded, command without echo in time is
+// lost and frees its place in window
+void load_expire( LoadConn &t_conn, double t_now, LoadStats &t_stats )
+{
+    while ( t_conn.m_pending && t_now - t_conn.m_sent_at[ t_conn.m_pend_head ] > LOAD_ECHO_TOUT )
+    {
+        t_conn.m_pend_head = ( t_conn.m_pend_head + 1 ) % LOAD_WINDOW_MAX;
+        t_conn.m_pending--;
+        t_stats.m_lost++;
+    }
+}
+
+int load_run( const sockaddr_in &t_addr, const LoadConfig &t_cfg )
+{
+    // every connection needs descriptor
+    rlimit l_lim;
+    getrlimit( RLIMIT_NOFILE, &l_lim );
+    if ( l_lim.rlim_cur < ( rlim_t ) t_cfg.m_conns + 16 )
+    {
+        l_lim.rlim_cur = MIN( l_lim.rlim_max, ( rlim_t ) t_cfg.m_conns + 16 );
+        setrlimit( RLIMIT_NOFILE, &l_lim );
+    }
+
+    int l_epoll = epoll_create1( 0 );
+    int l_timer = timerfd_create( CLOCK_MONOTONIC, TFD_NONBLOCK );
+    itimerspec l_its = { { 0, 1000000 }, { 0, 1000000 } };
+    timerfd_settime( l_timer, 0, &l_its, nullptr );
+
+    const uint32_t l_timer_id = UINT32_MAX;
+    epoll_event l_ev = { EPOLLIN, { .u32 = l_timer_id } };
+    epoll_ctl( l_epoll, EPOLL_CTL_ADD, l_timer, &l_ev );
+
+    LoadConn *l_conns = new LoadConn[ t_cfg.m_conns ];
+    LoadStats l_stats;
+    bzero( &l_stats, sizeof( l_stats ) );
+    l_stats.m_setup_min = 1e9;
+
+    double l_start = now_sec();
+
+    // all connects at once, they complete by EPOLLOUT
+    for ( int i = 0; i < t_cfg.m_conns; i++ )
+    {
+        LoadConn &l_conn = l_conns[ i ];
+        bzero( &l_conn, sizeof( l_conn ) );
+        l_conn.m_state = LOAD_CLOSED;
+
+        l_conn.m_fd = socket( AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0 );
+        if ( l_conn.m_fd < 0 )
+        {
+            log_msg( LOG_ERROR, "Unable to create socket %d.", i );
+            l_stats.m_failed++;
+            continue;
+        }
+        int l_one = 1;
+        setsockopt( l_conn.m_fd, IPPROTO_TCP, TCP_NODELAY, &l_one, sizeof( l_one ) );
+
+        l_conn.m_start = now_sec();
+        if ( connect( l_conn.m_fd, ( const sockaddr * ) &t_addr, sizeof( t_addr ) ) < 0 && errno != EINPROGRESS )
+        {
+            l_stats.m_failed++;
+            close( l_conn.m_fd );
+            continue;
+        }
+        l_conn.m_state = LOAD_CONNECTING;
+        l_ev.events = EPOLLOUT | EPOLLIN | EPOLLRDHUP;
+        l_ev.data.u32 = i;
+        epoll_ctl( l_epoll, EPOLL_CTL_ADD, l_conn.m_fd, &l_ev );
+    }
+
+    log_msg( LOG_INFO, "Load %d connections, %.0f commands/s, window %d, mix %d:%d:%d, %.0f s.",
+             t_cfg.m_conns, t_cfg.m_rate, t_cfg.m_window, t_cfg.m_mix[ 0 ], t_cfg.m_mix[ 1 ], t_cfg.m_mix[ 2 ], t_cfg.m_time );
+
+    double l_tokens = 0, l_last = l_start, l_report = l_start + 1;
+    long l_report_sent = 0, l_report_echoed = 0, l_report_lost = 0;
+    int l_next = 0;
+
+    while ( now_sec() - l_start < t_cfg.m_time )
+    {
+        epoll_event l_events[ 256 ];
+        int l_count = epoll_wait( l_epoll, l_events, 256, 100 );
+        if ( l_count < 0 && errno != EINTR ) break;
+
+        for ( int e = 0; e < l_count; e++ )
+        {
+            uint32_t l_id = l_events[ e ].data.u32;
+            uint32_t l_what = l_events[ e ].events;
+
+            if ( l_id == l_timer_id )
+            {
+                uint64_t l_ticks;
+                if ( read( l_timer, &l_ticks, sizeof( l_ticks ) ) < 0 ) {}
+                continue;
+            }
+
+            LoadConn &l_conn = l_conns[ l_id ];
+            if ( l_conn.m_state == LOAD_CONNECTING )
+            {
+                int l_err = 0;
+                socklen_t l_err_len = sizeof( l_err );
+                getsockopt( l_conn.m_fd, SOL_SOCKET, SO_ERROR, &l_err, &l_err_len );
+                if ( l_err || !( l_what & EPOLLOUT ) )
+                {
+                    l_stats.m_failed++;
+                    load_close( l_epoll, l_conn );
+                    continue;
+                }
+
+                double l_setup = now_sec() - l_conn.m_start;
+                l_stats.m_connected++;
+                l_stats.m_setup_sum += l_setup;
+                l_stats.m_setup_min = MIN( l_stats.m_setup_min, l_setup );
+                l_stats.m_setup_max = MAX( l_stats.m_setup_max, l_setup );
+                l_stats.m_setup_last = now_sec() - l_start;
+                l_conn.m_state = LOAD_OPEN;
+
+                l_ev.events = EPOLLIN | EPOLLRDHUP;
+                l_ev.data.u32 = l_id;
+                epoll_ctl( l_epoll, EPOLL_CTL_MOD, l_conn.m_fd, &l_ev );
+                continue;
+            }
+            if ( l_conn.m_state != LOAD_OPEN ) continue;
+
+            if ( l_what & ( EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR ) )
+                load_read( l_epoll, l_conn, l_stats );
+
+            if ( l_conn.m_state == LOAD_OPEN && ( l_what & EPOLLOUT ) )
+            {
+                l_ev.events = EPOLLIN | EPOLLRDHUP;
+                l_ev.data.u32 = l_id;
+                epoll_ctl( l_epoll, EPOLL_CTL_MOD, l_conn.m_fd, &l_ev );
+                load_flush( l_epoll, l_conn, l_id, l_stats );
+            }
+        }
+
+        // tokens for target rate, one command per open connection in turn
+        double l_now = now_sec();
+        l_tokens = t_cfg.m_rate > 0 ? MIN( l_tokens + ( l_now - l_last ) * t_cfg.m_rate, t_cfg.m_rate / 10 + 1 ) : 1e9;
+        l_last = l_now;
+
+        for ( int i = 0; i < t_cfg.m_conns; i++ )
+            if ( l_conns[ i ].m_state == LOAD_OPEN ) load_expire( l_conns[ i ], l_now, l_stats );
+
+        for ( int l_idle = 0; l_tokens >= 1 && l_idle < t_cfg.m_conns; )
+        {
+            uint32_t l_id = l_next;
+            LoadConn &l_conn = l_conns[ l_id ];
+            l_next = ( l_next + 1 ) % t_cfg.m_conns;
+
+            if ( l_conn.m_state != LOAD_OPEN || l_conn.m_out_len || l_conn.m_pending >= t_cfg.m_window )
+            {
+                l_idle++;
+                continue;
+            }
+            l_idle = 0;
+
+            l_conn.m_out_len = load_command( t_cfg, l_conn.m_out );
+            l_conn.m_sent_at[ ( l_conn.m_pend_head + l_conn.m_pending ) % LOAD_WINDOW_MAX ] = l_now;
+            l_conn.m_pending++;
+            l_stats.m_sent++;
+            l_tokens--;
+            load_flush( l_epoll, l_conn, l_id, l_stats );
+        }
+
+        if ( l_now >= l_report )
+        {
+            int l_open = 0;
+            for ( int i = 0; i < t_cfg.m_conns; i++ ) l_open += l_conns[ i ].m_state == LOAD_OPEN;
+
+            log_msg( LOG_INFO, "%3.0f s  open %d  sent %ld/s  echoed %ld/s  lost %ld/s  failed %ld  closed %ld  errors %ld",
+                     l_now - l_start, l_open, l_stats.m_sent - l_report_sent, l_stats.m_echoed - l_report_echoed,
+                     l_stats.m_lost - l_report_lost, l_stats.m_failed, l_stats.m_closed, l_stats.m_errors );
+            l_report_sent = l_stats.m_sent;
+            l_report_echoed = l_stats.m_echoed;
+            l_report_lost = l_stats.m_lost;
+            l_report += 1;
+        }
+    }
+
+    double l_elapsed = now_sec() - l_start;
+
+    for ( int i = 0; i < t_cfg.m_conns; i++ )
+        if ( l_conns[ i ].m_state != LOAD_CLOSED ) load_close( l_epoll, l_conns[ i ] );
+    delete [] l_conns;
+    close( l_timer );
+    close( l_epoll );
+
+    log_msg( LOG_INFO, "Connections: %ld of %d connected, %ld failed, %ld closed by server, %ld errors.",
+             l_stats.m_connected, t_cfg.m_conns, l_stats.m_failed, l_stats.m_closed, l_stats.m_errors );
+    if ( l_stats.m_connected )
+        log_msg( LOG_INFO, "Setup: min %.2f avg %.2f max %.2f ms, last connected at %.2f ms.",
+                 l_stats.m_setup_min * 1e3, l_stats.m_setup_sum / l_stats.m_connected * 1e3,
+                 l_stats.m_setup_max * 1e3, l_stats.m_setup_last * 1e3 );
+    log_msg( LOG_INFO, "Commands: sent %ld, echoed %ld, lost %ld, %.0f commands/s, %ld full socket stalls.",
+             l_stats.m_sent, l_stats.m_echoed, l_stats.m_lost, l_stats.m_echoed / l_elapsed, l_stats.m_stalls );
+
+    return l_stats.m_errors || l_stats.m_failed ? 1 : 0;
+}
+
+//***************************************************************************
+// round trip latency, log-linear histogram like HdrHistogram
+
+// 2^HIST_SUB_BITS linear buckets in every power of two, error < 1/32
+#define HIST_SUB_BITS           5
+#define HIST_SUB                ( 1 << HIST_SUB_BITS )
+#define HIST_GROUPS             40
+#define HIST_SIZE               ( ( HIST_GROUPS + 1 ) * HIST_SUB )
+
+struct LatHist
+{
+    uint64_t m_counts[ HIST_SIZE ];
+    uint64_t m_total;
+    uint64_t m_max;
+
+    void reset() { bzero( this, sizeof( *this ) ); }
+
+    // values below HIST_SUB have own bucket, others share bucket
+    // with values of the same top HIST_SUB_BITS + 1 bits
+    static int index( uint64_t t_val )
+    {
+        if ( t_val < HIST_SUB ) return t_val;
+        int l_group = 63 - __builtin_clzll( t_val ) - HIST_SUB_BITS + 1;
+        if ( l_group > HIST_GROUPS ) return HIST_SIZE - 1;
+        return l_group * HIST_SUB + ( ( t_val >> ( l_group - 1 ) ) - HIST_SUB );
+    }
+
+    static uint64_t low( int t_index )
+    {
+        int l_group = t_index / HIST_SUB;
+        if ( !l_group ) return t_index;
+        return ( uint64_t ) ( t_index % HIST_SUB + HIST_SUB ) << ( l_group - 1 );
+    }
+
+    static uint64_t high( int t_index )
+    {
+        int l_group = t_index / HIST_SUB;
+        return low( t_index ) + ( l_group ? ( 1ULL << ( l_group - 1 ) ) : 1 ) - 1;
+    }
+
+    void add( uint64_t t_val )
+    {
+        m_counts[ index( t_val ) ]++;
+        m_total++;
+        m_max = MAX( m_max, t_val );
+    }
+
+    void add( const LatHist &t_hist )
+    {
+        for ( int i = 0; i < HIST_SIZE; i++ ) m_counts[ i ] += t_hist.m_counts[ i ];
+        m_total += t_hist.m_total;
+        m_max = MAX( m_max, t_hist.m_max );
+    }
+
+    // upper edge of bucket with t_pct percent of values
+    uint64_t percentile( double t_pct ) const
+    {
+        uint64_t l_need = ( uint64_t ) ( t_pct / 100 * m_total + 0.5 ), l_sum = 0;
+        if ( !l_need ) l_need = 1;
+        for ( int i = 0; i < HIST_SIZE; i++ )
+        {
+            l_sum += m_counts[ i ];
+            if ( l_sum >= l_need ) return MIN( high( i ), m_max );
+        }
+        return m_max;
+    }
+
+    void print( const char *t_label ) const
+    {
+        if ( !m_total )
+        {
+            log_msg( LOG_INFO, "%s no echo", t_label );
+            return;
+        }
+        log_msg( LOG_INFO, "%s n %lu  p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f us", t_label,
+                 ( unsigned long ) m_total, percentile( 50 ) / 1e3, percentile( 90 ) / 1e3,
+                 percentile( 99 ) / 1e3, percentile( 99.9 ) / 1e3, m_max / 1e3 );
+    }
+
+    // one line per used bucket, values in us
+    bool csv( const char *t_file ) const
+    {
+        FILE *l_out = fopen( t_file, "w" );
+        if ( !l_out ) return false;
+
+        uint64_t l_sum = 0;
+        fprintf( l_out, "low_us,high_us,count,cumulative\n" );
+        for ( int i = 0; i < HIST_SIZE; i++ )
+        {
+            if ( !m_counts[ i ] ) continue;
+            l_sum += m_counts[ i ];
+            fprintf( l_out, "%.3f,%.3f,%lu,%.6f\n", low( i ) / 1e3, ( high( i ) + 1 ) / 1e3,
+                     ( unsigned long ) m_counts[ i ], ( double ) l_sum / m_total );
+        }
+        return fclose( l_out ) == 0;
+    }
+};
+
+struct LatConfig
+{
+    long m_count = 1000;        // commands, 0 until Ctrl+C
+    double m_interval = 0;      // ms between commands, 0 next after echo
+    double m_report = 1;        // s
+    const char *m_csv = nullptr;
+    bool m_nodelay = false;
+};
+
+#define LAT_FIFO                4096
+#define LAT_TOUT_NS             2000000000ULL   // command without echo is lost
+
+struct LatPending
+{
+    uint64_t m_start;           // latency is measured from, scheduled time in open loop
+    uint64_t m_sent;
+};
+
+volatile sig_atomic_t g_stop = 0;
+
+void stop_handler( int ) { g_stop = 1; }
+
+uint64_t now_ns()
+{
+    timespec l_ts;
+    clock_gettime( CLOCK_MONOTONIC, &l_ts );
+    return l_ts.tv_sec * 1000000000ULL + l_ts.tv_nsec;
+}
+
+// Command number t_index without '\n', returns its length
+int lat_command( char *t_buf, long t_index )
+{
+    return sprintf( t_buf, "LED L %ld", t_index % ( LED_NUM + 1 ) );
+}
+
+int lat_run( int t_sock, const LatConfig &t_cfg )
+{
+    static LatHist s_total, s_period;
+    static LatPending s_fifo[ LAT_FIFO ];   // commands without echo, index is command number
+    long l_head = 0, l_tail = 0, l_sent = 0, l_lost = 0, l_period_lost = 0;
+    char l_line[ 64 ];
+    int l_line_len = 0;
+
+    s_total.reset();
+    s_period.reset();
+    signal( SIGINT, stop_handler );
+
+    int l_one = t_cfg.m_nodelay;
+    setsockopt( t_sock, IPPROTO_TCP, TCP_NODELAY, &l_one, sizeof( l_one ) );
+
+    log_msg( LOG_INFO, "Latency of %ld commands, interval %.3f ms, Nagle %s, Ctrl+C to stop.",
+             t_cfg.m_count, t_cfg.m_interval, t_cfg.m_nodelay ? "off" : "on" );
+
+    uint64_t l_interval = t_cfg.m_interval * 1e6;
+    uint64_t l_next = now_ns(), l_report = l_next + t_cfg.m_report * 1e9;
+
+    while ( !g_stop )
+    {
+        uint64_t l_now = now_ns();
+        bool l_more = !t_cfg.m_count || l_sent < t_cfg.m_count;
+
+        // open loop with interval, closed loop without it
+        if ( l_more && l_now >= l_next && l_tail - l_head < LAT_FIFO && ( l_interval || l_tail == l_head ) )
+        {
+            char l_cmd[ 32 ];
+            int l_len = lat_command( l_cmd, l_tail );
+            l_cmd[ l_len++ ] = '\n';
+
+            // late send is part of latency, as in HdrHistogram
+            LatPending &l_pend = s_fifo[ l_tail++ % LAT_FIFO ];
+            l_pend.m_sent = now_ns();
+            l_pend.m_start = l_interval ? l_next : l_pend.m_sent;
+            if ( write_all( t_sock, l_cmd, l_len ) < 0 )
+            {
+                log_msg( LOG_ERROR, "Unable to send data to server." );
+                break;
+            }
+            l_sent++;
+            l_next = l_interval ? l_next + l_interval : l_now;
+            continue;
+        }
+
+        // echo may be dropped by server, closed loop then continues
+        while ( l_head != l_tail && l_now - s_fifo[ l_head % LAT_FIFO ].m_sent > LAT_TOUT_NS )
+        {
+            l_head++;
+            l_period_lost++;
+        }
+
+        if ( !l_more && l_tail == l_head ) break;
+
+        if ( l_now >= l_report )
+        {
+            s_period.print( "LAT" );
+            if ( l_period_lost ) log_msg( LOG_INFO, "LAT lost %ld", l_period_lost );
+            l_lost += l_period_lost;
+            l_period_lost = 0;
+            s_total.add( s_period );
+            s_period.reset();
+            l_report += t_cfg.m_report * 1e9;
+        }
+
+        // wait for echo, next command or report
+        uint64_t l_wake = l_report;
+        if ( l_more && ( l_interval || l_tail == l_head ) ) l_wake = MIN( l_wake, l_next );
+        if ( l_tail != l_head ) l_wake = MIN( l_wake, s_fifo[ l_head % LAT_FIFO ].m_sent + LAT_TOUT_NS + 1 );
+        pollfd l_poll = { t_sock, POLLIN, 0 };
+        uint64_t l_wait = l_wake > l_now ? l_wake - l_now : 0;
+        timespec l_tout = { ( time_t ) ( l_wait / 1000000000 ), ( long ) ( l_wait % 1000000000 ) };
+        if ( ppoll( &l_poll, 1, &l_tout, nullptr ) <= 0 || !( l_poll.revents & POLLIN ) ) continue;
+
+        char l_buf[ 1024 ];
+        int l_len = read( t_sock, l_buf, sizeof( l_buf ) );
+        uint64_t l_recv = now_ns();
+        if ( l_len <= 0 )
+        {
+            log_msg( l_len ? LOG_ERROR : LOG_INFO, "Server closed socket." );
+            break;
+        }
+
+        for ( int i = 0; i < l_len; i++ )
+        {
+            if ( l_buf[ i ] != '\n' )
+            {
+                if ( l_line_len < ( int ) sizeof( l_line ) ) l_line[ l_line_len++ ] = l_buf[ i ];
+                continue;
+            }
+            // button states are not echoes
+            const char *l_echo = l_line;
+            int l_echo_len = l_line_len;
+            l_line_len = 0;
+            if ( line_kind( l_echo, l_echo_len ) != LINE_REPLY ) continue;
+
+            // echoes come in order, echo is the same line as its command,
+            // commands before it lost their echoes
+            long l_match = l_head;
+            for ( ; l_match != l_tail; l_match++ )
+            {
+                char l_cmd[ 32 ];
+                int l_cmd_len = lat_command( l_cmd, l_match );
+                if ( l_echo_len == l_cmd_len && !memcmp( l_echo, l_cmd, l_cmd_len ) ) break;
+            }
+            if ( l_match == l_tail ) continue;
+
+            l_period_lost += l_match - l_head;
+            s_period.add( l_recv - s_fifo[ l_match % LAT_FIFO ].m_start );
+            l_head = l_match + 1;
+        }
+    }
+
+    s_total.add( s_period );
+    s_total.print( "LAT total" );
+    l_lost += l_period_lost;
+    if ( l_lost )
+        log_msg( LOG_INFO, "%ld commands lost, no echo in %.0f s.", l_lost, LAT_TOUT_NS / 1e9 );
+    if ( l_tail != l_head )
+        log_msg( LOG_INFO, "%ld commands without echo.", l_tail - l_head );
+
+    if ( t_cfg.m_csv )
+    {
+        if ( s_total.csv( t_cfg.m_csv ) )
+            log_msg( LOG_INFO, "Histogram written to '%s'.", t_cfg.m_csv );
+        else
+            log_msg( LOG_ERROR, "Unable to write '%s'.", t_cfg.m_csv );
+    }
+
+    return 0;
+}
+
+//***************************************************************************
+// replay of timestamped script, one "time_offset_us command" per line
+
+struct ReplayCmd
+{
+    uint64_t m_offset;          // ns from start, already scaled
+    char m_text[ 64 ];          // with '\n'
+    int m_len;
+    uint64_t m_sent;            // ns from start
+    uint64_t m_echo;            // ns from start, 0 without echo
+};
+
+struct ReplayConfig
+{
+    const char *m_script = nullptr;
+    double m_speed = 1;         // 2 twice faster, 0 as fast as possible
+    const char *m_out = nullptr;
+};
+
+struct ReplayShared
+{
+    int m_sock;
+    ReplayCmd *m_cmds;
+    uint64_t m_start;
+    std::atomic< long > m_sent;
+    std::atomic< long > m_echoed;   // commands before it got echo or lost it
+};
+
+// Load script, empty lines and lines starting with # are skipped,
+// commands longer than LED_LINE_MAX are skipped with message, board
+// would drop them without echo
+ReplayCmd *replay_load( const ReplayConfig &t_cfg, long &t_count )
+{
+    FILE *l_in = fopen( t_cfg.m_script, "r" );
+    if ( !l_in ) return nullptr;
+
+    ReplayCmd *l_cmds = nullptr;
+    long l_size = 0, l_line_no = 0;
+    char l_line[ 256 ];
+    t_count = 0;
+
+    while ( fgets( l_line, sizeof( l_line ), l_in ) )
+    {
+        l_line_no++;
+        char *l_cmd;
+        double l_us = strtod( l_line, &l_cmd );
+        if ( l_cmd == l_line || *l_line == '#' ) continue;
+
+        while ( *l_cmd == ' ' || *l_cmd == '\t' ) l_cmd++;
+        l_cmd[ strcspn( l_cmd, "\r\n" ) ] = '\0';
+        if ( !*l_cmd ) continue;
+
+        int l_len = strlen( l_cmd );
+        if ( l_len > LED_LINE_MAX )
+        {
+            log_msg( LOG_INFO, "Line %ld: command longer than %d characters skipped.", l_line_no, LED_LINE_MAX );
+            continue;
+        }
+
+        if ( t_count == l_size )
+        {
+            l_size = l_size ? l_size * 2 : 1024;
+            l_cmds = ( ReplayCmd * ) realloc( l_cmds, l_size * sizeof( ReplayCmd ) );
+        }
+        ReplayCmd &l_rc = l_cmds[ t_count++ ];
+        l_rc.m_offset = t_cfg.m_speed > 0 ? l_us * 1e3 / t_cfg.m_speed : 0;
+        memcpy( l_rc.m_text, l_cmd, l_len );
+        l_rc.m_text[ l_len ] = '\n';
+        l_rc.m_len = l_len + 1;
+        l_rc.m_sent = l_rc.m_echo = 0;
+    }
+    fclose( l_in );
+    return l_cmds;
+}
+
+// Receiving thread. Board echoes commands in order, so echo belongs to the
+// oldest command with the same text sent less than LAT_TOUT_NS ago.
+// Commands before it lost their echo.
+void *replay_receiver( void *t_arg )
+{
+    ReplayShared *l_sh = ( ReplayShared * ) t_arg;
+    char l_buf[ 1024 ], l_line[ 64 ];
+    int l_line_len = 0;
+
+    while ( 1 )
+    {
+        int l_len = read( l_sh->m_sock, l_buf, sizeof( l_buf ) );
+        uint64_t l_now = now_ns() - l_sh->m_start;
+        if ( l_len <= 0 ) break;
+
+        for ( int i = 0; i < l_len; i++ )
+        {
+            if ( l_buf[ i ] != '\n' )
+            {
+                if ( l_line_len < ( int ) sizeof( l_line ) ) l_line[ l_line_len++ ] = l_buf[ i ];
+                continue;
+            }
+            const char *l_echo = l_line;
+            int l_echo_len = l_line_len;
+            l_line_len = 0;
+            if ( line_kind( l_echo, l_echo_len ) != LINE_REPLY ) continue;
+
+            long l_sent = l_sh->m_sent.load();
+            for ( long l_match = l_sh->m_echoed.load(); l_match < l_sent; l_match++ )
+            {
+                ReplayCmd &l_rc = l_sh->m_cmds[ l_match ];
+                if ( l_now - l_rc.m_sent > LAT_TOUT_NS ) continue;
+                if ( l_rc.m_len != l_echo_len + 1 || memcmp( l_rc.m_text, l_echo, l_echo_len ) ) continue;
+
+                l_rc.m_echo = l_now;
+                l_sh->m_echoed.store( l_match + 1 );
+                break;
+            }
+        }
+    }
+    return nullptr;
+}
+
+int replay_run( int t_sock, const ReplayConfig &t_cfg )
+{
+    long l_count;
+    ReplayCmd *l_cmds = replay_load( t_cfg, l_count );
+    if ( !l_cmds )
+    {
+        log_msg( LOG_ERROR, "Unable to read script '%s'.", t_cfg.m_script );
+        return 1;
+    }
+
+    FILE *l_out = t_cfg.m_out ? fopen( t_cfg.m_out, "w" ) : stdout;
+    if ( !l_out )
+    {
+        log_msg( LOG_ERROR, "Unable to create '%s'.", t_cfg.m_out );
+        return 1;
+    }
+
+    int l_one = 1;
+    setsockopt( t_sock, IPPROTO_TCP, TCP_NODELAY, &l_one, sizeof( l_one ) );
+
+    log_msg( LOG_INFO, "Replay of %ld commands, speed %g.", l_count, t_cfg.m_speed );
+
+    ReplayShared l_sh;
+    l_sh.m_sock = t_sock;
+    l_sh.m_cmds = l_cmds;
+    l_sh.m_sent = 0;
+    l_sh.m_echoed = 0;
+    l_sh.m_start = now_ns();
+
+    pthread_t l_thread;
+    pthread_create( &l_thread, nullptr, replay_receiver, &l_sh );
+
+    // absolute deadlines, late command does not shift following ones
+    for ( long i = 0; i < l_count; i++ )
+    {
+        uint64_t l_deadline = l_sh.m_start + l_cmds[ i ].m_offset;
+        timespec l_ts = { ( time_t ) ( l_deadline / 1000000000ULL ), ( long ) ( l_deadline % 1000000000ULL ) };
+        while ( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &l_ts, nullptr ) == EINTR ) {}
+
+        l_cmds[ i ].m_sent = now_ns() - l_sh.m_start;
+        l_sh.m_sent.store( i + 1 );
+        if ( write_all( t_sock, l_cmds[ i ].m_text, l_cmds[ i ].m_len ) < 0 )
+        {
+            log_msg( LOG_ERROR, "Unable to send data to server." );
+            l_count = i + 1;
+            break;
+        }
+    }
+
+    // the last echoes
+    uint64_t l_end = now_ns() + LAT_TOUT_NS;
+    while ( l_sh.m_echoed.load() < l_sh.m_sent.load() && now_ns() < l_end ) usleep( 1000 );
+    shutdown( t_sock, SHUT_RDWR );
+    pthread_join( l_thread, nullptr );
+
+    static LatHist s_rtt, s_late;
+    s_rtt.reset();
+    s_late.reset();
+
+    fprintf( l_out, "index,offset_us,sent_us,late_us,echo_us,rtt_us,command\n" );
+    for ( long i = 0; i < l_count; i++ )
+    {
+        ReplayCmd &l_rc = l_cmds[ i ];
+        uint64_t l_late = l_rc.m_sent - MIN( l_rc.m_sent, l_rc.m_offset );
+        s_late.add( l_late );
+
+        l_rc.m_text[ l_rc.m_len - 1 ] = '\0';
+        if ( l_rc.m_echo )
+        {
+            s_rtt.add( l_rc.m_echo - l_rc.m_sent );
+            fprintf( l_out, "%ld,%.3f,%.3f,%.3f,%.3f,%.3f,%s\n", i, l_rc.m_offset / 1e3, l_rc.m_sent / 1e3,
+                     l_late / 1e3, l_rc.m_echo / 1e3, ( l_rc.m_echo - l_rc.m_sent ) / 1e3, l_rc.m_text );
+        }
+        else
+            fprintf( l_out, "%ld,%.3f,%.3f,%.3f,,,%s\n", i, l_rc.m_offset / 1e3, l_rc.m_sent / 1e3,
+                     l_late / 1e3, l_rc.m_text );
+    }
+    if ( l_out != stdout ) fclose( l_out );
+
+    s_late.print( "Send late" );
+    s_rtt.print( "Round trip" );
+    if ( s_rtt.m_total < ( uint64_t ) l_count )
+        log_msg( LOG_INFO, "%ld commands without echo.", l_count - ( long ) s_rtt.m_total );
+
+    free( l_cmds );
+    return 0;
+}
+
+//***************************************************************************
+// mirrored ring, the same pages are mapped twice one after another, so
+// data from read pointer are always contiguous and parsed in place
+
+class MirrorRing
+{
+public:
+    ~MirrorRing()
+    {
+        if ( m_base ) munmap( m_base, 2 * m_size );
+    }
+
+    // t_size is rounded up to pages
+    bool init( size_t t_size )
+    {
+        size_t l_page = sysconf( _SC_PAGESIZE );
+        m_size = ( t_size + l_page - 1 ) / l_page * l_page;
+        m_head = m_tail = 0;
+
+        int l_fd = memfd_create( "socket_cl_ring", 0 );
+        if ( l_fd < 0 ) return false;
+
+        // reserve address space for both halves, then map file into them
+        uint8_t *l_base = ( uint8_t * ) mmap( nullptr, 2 * m_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+        bool l_ok = l_base != MAP_FAILED && ftruncate( l_fd, m_size ) == 0 &&
+                mmap( l_base, m_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, l_fd, 0 ) != MAP_FAILED &&
+                mmap( l_base + m_size, m_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, l_fd, 0 ) != MAP_FAILED;
+        close( l_fd );
+
+        if ( !l_ok )
+        {
+            if ( l_base != MAP_FAILED ) munmap( l_base, 2 * m_size );
+            return false;
+        }
+        m_base = l_base;
+        return true;
+    }
+
+    uint8_t *write_ptr() { return m_base + m_head % m_size; }
+    size_t write_space() const { return m_size - ( m_head - m_tail ); }
+    void commit( size_t t_len ) { m_head += t_len; }
+
+    const uint8_t *read_ptr() const { return m_base + m_tail % m_size; }
+    size_t read_len() const { return m_head - m_tail; }
+    void consume( size_t t_len ) { m_tail += t_len; }
+
+private:
+    uint8_t *m_base = nullptr;
+    size_t m_size = 0;
+    uint64_t m_head, m_tail;    // free running
+};
+
+//***************************************************************************
+// recorder of button telemetry
+//
+// File is sequence of sessions. Session starts with 16 byte header:
+// REC_MAGIC and CLOCK_REALTIME of start in ns (uint64). Every record has
+// 6 bytes: time from previous record in us (uint32) and pressed buttons
+// with changed ones in upper byte (uint16), both little endian. Record
+// REC_GAP only moves time by 0xFFFFFFFF us.
+
+#define REC_MAGIC               "SCBTN01\n"
+#define REC_HEADER_SIZE         16
+#define REC_SIZE                6
+#define REC_GAP                 0xFFFF
+#define REC_BUF_SIZE            ( 64 * 1024 )
+#define REC_FLUSH_NS            1000000000ULL
+
+class ButtonRecorder
+{
+public:
+    ~ButtonRecorder() { close(); }
+
+    bool open( const char *t_file )
+    {
+        m_fd = ::open( t_file, O_WRONLY | O_CREAT | O_APPEND, 0644 );
+        if ( m_fd < 0 ) return false;
+
+        timespec l_ts;
+        clock_gettime( CLOCK_REALTIME, &l_ts );
+        uint64_t l_real = l_ts.tv_sec * 1000000000ULL + l_ts.tv_nsec;
+
+        memcpy( m_buf, REC_MAGIC, 8 );
+        put( m_buf + 8, l_real, 8 );
+        m_len = REC_HEADER_SIZE;
+        m_last = m_flushed = now_ns();
+        return true;
+    }
+
+    bool is_open() const { return m_fd >= 0; }
+
+    void add( uint8_t t_pressed, uint8_t t_changed )
+    {
+        uint64_t l_now = now_ns();
+        uint64_t l_us = ( l_now - m_last ) / 1000;
+        m_last += l_us * 1000;
+
+        for ( ; l_us >= 0xFFFFFFFF; l_us -= 0xFFFFFFFF )
+            record( 0xFFFFFFFF, REC_GAP );
+        record( l_us, t_pressed | ( t_changed << 8 ) );
+        m_records++;
+        flush_due();
+    }
+
+    // at most REC_FLUSH_NS of records is lost when client is killed
+    void flush_due()
+    {
+        if ( m_fd >= 0 && m_len && now_ns() - m_flushed >= REC_FLUSH_NS ) flush();
+    }
+
+    void close()
+    {
+        if ( m_fd < 0 ) return;
+        flush();
+        ::close( m_fd );
+        m_fd = -1;
+    }
+
+    uint64_t records() const { return m_records; }
+    uint64_t bytes() const { return m_bytes; }
+
+private:
+    int m_fd = -1;
+    uint8_t m_buf[ REC_BUF_SIZE ];
+    size_t m_len = 0;
+    uint64_t m_last = 0;        // time of previous record in ns, whole us
+    uint64_t m_flushed = 0;     // time of last write in ns
+    uint64_t m_records = 0;
+    uint64_t m_bytes = 0;
+
+    static void put( uint8_t *t_buf, uint64_t t_val, int t_bytes )
+    {
+        for ( int i = 0; i < t_bytes; i++ ) t_buf[ i ] = t_val >> ( 8 * i );
+    }
+
+    void record( uint32_t t_us, uint16_t t_state )
+    {
+        if ( m_len + REC_SIZE > sizeof( m_buf ) ) flush();
+        put( m_buf + m_len, t_us, 4 );
+        put( m_buf + m_len + 4, t_state, 2 );
+        m_len += REC_SIZE;
+    }
+
+    // one write for many records, records are never dropped
+    void flush()
+    {
+        if ( write_all( m_fd, m_buf, m_len ) < 0 )
+            log_msg( LOG_ERROR, "Unable to write record." );
+        m_bytes += m_len;
+        m_len = 0;
+        m_flushed = now_ns();
+    }
+};
+
+// Print recording as text, one line per record
+int rec_dump( const char *t_file )
+{
+    FILE *l_in = fopen( t_file, "rb" );
+    if ( !l_in )
+    {
+        log_msg( LOG_ERROR, "Unable to read '%s'.", t_file );
+        return 1;
+    }
+
+    uint8_t l_rec[ REC_HEADER_SIZE ];
+    uint64_t l_us = 0;
+
+    while ( fread( l_rec, 1, REC_SIZE, l_in ) == REC_SIZE )
+    {
+        if ( !memcmp( l_rec, REC_MAGIC, REC_SIZE ) )
+        {
+            if ( fread( l_rec + REC_SIZE, 1, REC_HEADER_SIZE - REC_SIZE, l_in ) != REC_HEADER_SIZE - REC_SIZE ) break;
+            uint64_t l_real = 0;
+            for ( int i = 7; i >= 0; i-- ) l_real = ( l_real << 8 ) | l_rec[ 8 + i ];
+            time_t l_sec = l_real / 1000000000ULL;
+            char l_time[ 64 ];
+            strftime( l_time, sizeof( l_time ), "%F %T", localtime( &l_sec ) );
+            printf( "# session %s\n", l_time );
+            l_us = 0;
+            continue;
+        }
+
+        uint32_t l_dt = l_rec[ 0 ] | ( l_rec[ 1 ] << 8 ) | ( l_rec[ 2 ] << 16 ) | ( ( uint32_t ) l_rec[ 3 ] << 24 );
+        uint16_t l_state = l_rec[ 4 ] | ( l_rec[ 5 ] << 8 );
+        l_us += l_dt;
+        if ( l_state == REC_GAP && l_dt == 0xFFFFFFFF ) continue;
+
+        printf( "%.6f %02X %02X\n", l_us / 1e6, l_state & 0xFF, l_state >> 8 );
+    }
+    fclose( l_in );
+    return 0;
+}
 
 //***************************************************************************
-// log messages
+// fleet, one command stream to many boards, all sockets in one poll loop
 
-#define LOG_ERROR               0       // errors
-#define LOG_INFO                1       // information and notifications
-#define LOG_DEBUG               2       // debug messages
+#define FLEET_CASTS             64          // broadcasts without all replies
+#define FLEET_CONNECT_TOUT_NS   3000000000ULL
 
-// debug flag
-int g_debug = LOG_INFO;
+struct FleetBoard
+{
+    char m_label[ 160 ];
+    sockaddr_in m_addr;
+    int m_fd;
+    LoadState m_state;
+    uint64_t m_start;           // connect() called
+    char m_in[ 256 ];           // incomplete line
+    int m_in_len;
+    char m_out[ 4096 ];         // unsent commands
+    int m_out_len;
+    long m_pending[ FLEET_CASTS ];  // broadcasts without echo, oldest first
+    int m_pend_head, m_pend_len;
+    long m_replies;
+};
 
-void log_msg( int t_log_level, const char *t_form, ... )
+struct FleetCast
 {
-    const char *out_fmt[] = {
-            "ERR: (%d-%s) %s\n",
-            "INF: %s\n",
-            "DEB: %s\n" };
+    long m_id;
+    char m_cmd[ LED_LINE_MAX + 1 ];
+    uint64_t m_start;
+    int m_sent, m_replies, m_lost;
+    uint64_t m_fast, m_slow;
+    int m_fast_board, m_slow_board;
+    bool m_done;
+};
 
-    if ( t_log_level && t_log_level > g_debug ) return;
+// Lines 'host port [label]', empty lines and lines starting with # are skipped
+FleetBoard *fleet_load( const char *t_file, int &t_count )
+{
+    FILE *l_in = fopen( t_file, "r" );
+    if ( !l_in ) return nullptr;
+
+    FleetBoard *l_boards = nullptr;
+    char l_line[ 256 ];
+    t_count = 0;
+
+    while ( fgets( l_line, sizeof( l_line ), l_in ) )
+    {
+        char l_host[ 128 ], l_label[ 64 ];
+        int l_port;
+        int l_fields = sscanf( l_line, "%127s %d %63s", l_host, &l_port, l_label );
+        if ( l_fields < 1 || *l_host == '#' ) continue;
+        if ( l_fields < 2 )
+        {
+            log_msg( LOG_ERROR, "Port is missing for '%s'.", l_host );
+            continue;
+        }
+
+        addrinfo l_ai_req, *l_ai_ans;
+        bzero( &l_ai_req, sizeof( l_ai_req ) );
+        l_ai_req.ai_family = AF_INET;
+        l_ai_req.ai_socktype = SOCK_STREAM;
+        if ( getaddrinfo( l_host, nullptr, &l_ai_req, &l_ai_ans ) )
+        {
+            log_msg( LOG_ERROR, "Unknown host name '%s'!", l_host );
+            continue;
+        }
+
+        l_boards = ( FleetBoard * ) realloc( l_boards, ( t_count + 1 ) * sizeof( FleetBoard ) );
+        FleetBoard &l_board = l_boards[ t_count++ ];
+        bzero( &l_board, sizeof( l_board ) );
+        l_board.m_addr = *( sockaddr_in * ) l_ai_ans->ai_addr;
+        l_board.m_addr.sin_port = htons( l_port );
+        l_board.m_fd = -1;
+        l_board.m_state = LOAD_CLOSED;
+        freeaddrinfo( l_ai_ans );
+
+        if ( l_fields == 3 )
+            snprintf( l_board.m_label, sizeof( l_board.m_label ), "%s", l_label );
+        else
+            snprintf( l_board.m_label, sizeof( l_board.m_label ), "%s:%d", l_host, l_port );
+    }
+    fclose( l_in );
+    return l_boards;
+}
+
+void fleet_close( FleetBoard &t_board, FleetCast *t_casts )
+{
+    if ( t_board.m_fd >= 0 ) close( t_board.m_fd );
+    t_board.m_fd = -1;
+    t_board.m_state = LOAD_CLOSED;
+
+    // broadcasts will not get reply from this board
+    for ( int i = 0; i < t_board.m_pend_len; i++ )
+    {
+        long l_id = t_board.m_pending[ ( t_board.m_pend_head + i ) % FLEET_CASTS ];
+        FleetCast &l_cast = t_casts[ l_id % FLEET_CASTS ];
+        if ( l_cast.m_id == l_id && !l_cast.m_done ) l_cast.m_lost++;
+    }
+    t_board.m_pend_len = 0;
+    t_board.m_out_len = 0;
+}
+
+// Remove broadcast t_id from pending ones of board, or the first t_drop ones when t_id is -1
+void fleet_unpend( FleetBoard &t_board, int t_drop, long t_id = -1 )
+{
+    int l_kept = 0;
+    for ( int i = 0; i < t_board.m_pend_len; i++ )
+    {
+        long l_id = t_board.m_pending[ ( t_board.m_pend_head + i ) % FLEET_CASTS ];
+        if ( t_id >= 0 ? l_id == t_id : i < t_drop ) continue;
+        t_board.m_pending[ ( t_board.m_pend_head + l_kept++ ) % FLEET_CASTS ] = l_id;
+    }
+    t_board.m_pend_len = l_kept;
+}
+
+// Write rest of commands, false when connection is broken
+bool fleet_flush( FleetBoard &t_board )
+{
+    if ( !t_board.m_out_len ) return true;
+
+    int l_len = write( t_board.m_fd, t_board.m_out, t_board.m_out_len );
+    if ( l_len < 0 ) return errno == EAGAIN;
+
+    t_board.m_out_len -= l_len;
+    memmove( t_board.m_out, t_board.m_out + l_len, t_board.m_out_len );
+    return true;
+}
+
+// All boards replied or timeout, print summary of broadcast
+void fleet_done( FleetCast &t_cast, FleetBoard *t_boards, int t_count, LatHist &t_skew, bool t_timeout )
+{
+    t_cast.m_done = true;
+
+    if ( !t_cast.m_replies )
+    {
+        log_msg( LOG_INFO, "#%ld '%s' no reply of %d boards.", t_cast.m_id, t_cast.m_cmd, t_cast.m_sent );
+        return;
+    }
+
+    uint64_t l_skew = t_cast.m_slow - t_cast.m_fast;
+    t_skew.add( l_skew );
+    log_msg( LOG_INFO, "#%ld '%s' replies %d/%d  fastest %s %.3f ms  slowest %s %.3f ms  skew %.3f ms",
+             t_cast.m_id, t_cast.m_cmd, t_cast.m_replies, t_cast.m_sent,
+             t_boards[ t_cast.m_fast_board ].m_label, t_cast.m_fast / 1e6,
+             t_boards[ t_cast.m_slow_board ].m_label, t_cast.m_slow / 1e6, l_skew / 1e6 );
+
+    if ( !t_timeout ) return;
+    for ( int b = 0; b < t_count; b++ )
+        for ( int i = 0; i < t_boards[ b ].m_pend_len; i++ )
+            if ( t_boards[ b ].m_pending[ ( t_boards[ b ].m_pend_head + i ) % FLEET_CASTS ] == t_cast.m_id )
+            {
+                log_msg( LOG_INFO, "#%ld no reply from %s.", t_cast.m_id, t_boards[ b ].m_label );
+                fleet_unpend( t_boards[ b ], 0, t_cast.m_id );
+                break;
+            }
+}
 
+// Print lines labelled by board. Board echoes commands in order, so non BTN
+// line is echo of the oldest pending broadcast with the same text, pending
+// broadcasts before it lost their echo.
+void fleet_read( FleetBoard *t_boards, int t_index, FleetCast *t_casts )
+{
+    FleetBoard &l_board = t_boards[ t_index ];
     char l_buf[ 1024 ];
-    va_list l_arg;
-    va_start( l_arg, t_form );
-    vsprintf( l_buf, t_form, l_arg );
-    va_end( l_arg );
 
-    switch ( t_log_level )
+    int l_len = read( l_board.m_fd, l_buf, sizeof( l_buf ) );
+    if ( l_len < 0 && errno == EAGAIN ) return;
+    if ( l_len <= 0 )
     {
-        case LOG_INFO:
-        case LOG_DEBUG:
-            fprintf( stdout, out_fmt[ t_log_level ], l_buf );
-            break;
+        log_msg( LOG_INFO, "[%s] connection closed.", l_board.m_label );
+        fleet_close( l_board, t_casts );
+        return;
+    }
 
-        case LOG_ERROR:
-            fprintf( stderr, out_fmt[ t_log_level ], errno, strerror( errno ), l_buf );
+    uint64_t l_now = now_ns();
+    for ( int i = 0; i < l_len; i++ )
+    {
+        if ( l_buf[ i ] != '\n' )
+        {
+            if ( l_board.m_in_len < ( int ) sizeof( l_board.m_in ) - 1 ) l_board.m_in[ l_board.m_in_len++ ] = l_buf[ i ];
+            continue;
+        }
+        l_board.m_in[ l_board.m_in_len ] = '\0';
+        const char *l_line = l_board.m_in;
+        LineKind l_kind = line_kind( l_line, l_board.m_in_len );
+        l_board.m_in_len = 0;
+
+        if ( l_kind == LINE_EMPTY ) continue;
+
+        int l_match = l_board.m_pend_len;
+        if ( l_kind == LINE_REPLY )
+            for ( l_match = 0; l_match < l_board.m_pend_len; l_match++ )
+                if ( !strcmp( t_casts[ l_board.m_pending[ ( l_board.m_pend_head + l_match ) % FLEET_CASTS ] % FLEET_CASTS ].m_cmd, l_line ) )
+                    break;
+
+        if ( l_match < l_board.m_pend_len )
+        {
+            long l_id = l_board.m_pending[ ( l_board.m_pend_head + l_match ) % FLEET_CASTS ];
+            FleetCast &l_cast = t_casts[ l_id % FLEET_CASTS ];
+            for ( int i = 0; i < l_match; i++ )
+            {
+                long l_lost = l_board.m_pending[ ( l_board.m_pend_head + i ) % FLEET_CASTS ];
+                log_msg( LOG_INFO, "#%ld no reply from %s.", l_lost, l_board.m_label );
+                t_casts[ l_lost % FLEET_CASTS ].m_lost++;
+            }
+            fleet_unpend( l_board, l_match + 1 );
+            l_board.m_replies++;
+
+            uint64_t l_rtt = l_now - l_cast.m_start;
+            if ( !l_cast.m_replies++ || l_rtt < l_cast.m_fast )
+            {
+                l_cast.m_fast = l_rtt;
+                l_cast.m_fast_board = t_index;
+            }
+            if ( l_rtt >= l_cast.m_slow )
+            {
+                l_cast.m_slow = l_rtt;
+                l_cast.m_slow_board = t_index;
+            }
+            printf( "[%s] #%ld %.3f ms: %s\n", l_board.m_label, l_id, l_rtt / 1e6, l_line );
+        }
+        else
+            printf( "[%s] %s\n", l_board.m_label, l_line );
+    }
+    fflush( stdout );
+}
+
+// Send command to all open boards, t_cmd has at most LED_LINE_MAX characters
+void fleet_cast( FleetBoard *t_boards, int t_count, FleetCast *t_casts, long t_id, const char *t_cmd )
+{
+    FleetCast &t_cast = t_casts[ t_id % FLEET_CASTS ];
+    bzero( &t_cast, sizeof( t_cast ) );
+    t_cast.m_id = t_id;
+    int l_len = strlen( t_cmd );
+    memcpy( t_cast.m_cmd, t_cmd, l_len + 1 );
+    t_cast.m_start = now_ns();
+
+    for ( int b = 0; b < t_count; b++ )
+    {
+        FleetBoard &l_board = t_boards[ b ];
+        if ( l_board.m_state != LOAD_OPEN ) continue;
+        if ( l_board.m_out_len + l_len + 1 > ( int ) sizeof( l_board.m_out ) || l_board.m_pend_len == FLEET_CASTS )
+        {
+            log_msg( LOG_INFO, "[%s] does not reply, connection closed.", l_board.m_label );
+            fleet_close( l_board, t_casts );
+            continue;
+        }
+
+        memcpy( l_board.m_out + l_board.m_out_len, t_cast.m_cmd, l_len );
+        l_board.m_out[ l_board.m_out_len + l_len ] = '\n';
+        l_board.m_out_len += l_len + 1;
+        l_board.m_pending[ ( l_board.m_pend_head + l_board.m_pend_len++ ) % FLEET_CASTS ] = t_id;
+        t_cast.m_sent++;
+
+        if ( !fleet_flush( l_board ) )
+        {
+            log_msg( LOG_INFO, "[%s] unable to send, connection closed.", l_board.m_label );
+            l_board.m_pend_len--;
+            t_cast.m_sent--;
+            fleet_close( l_board, t_casts );
+        }
+    }
+}
+
+int fleet_run( const char *t_file )
+{
+    int l_count;
+    FleetBoard *l_boards = fleet_load( t_file, l_count );
+    if ( !l_boards )
+    {
+        log_msg( LOG_ERROR, "No board in '%s'.", t_file );
+        return 1;
+    }
+
+    static FleetCast s_casts[ FLEET_CASTS ];
+    for ( int i = 0; i < FLEET_CASTS; i++ )
+    {
+        s_casts[ i ].m_id = -1;
+        s_casts[ i ].m_done = true;
+    }
+    static LatHist s_skew;
+    s_skew.reset();
+
+    signal( SIGINT, stop_handler );
+
+    // all connects at once, setup of fleet takes one round trip
+    uint64_t l_start = now_ns();
+    int l_connecting = 0;
+    for ( int b = 0; b < l_count; b++ )
+    {
+        FleetBoard &l_board = l_boards[ b ];
+        l_board.m_fd = socket( AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0 );
+        if ( l_board.m_fd < 0 )
+        {
+            log_msg( LOG_ERROR, "Unable to create socket." );
+            continue;
+        }
+        int l_one = 1;
+        setsockopt( l_board.m_fd, IPPROTO_TCP, TCP_NODELAY, &l_one, sizeof( l_one ) );
+
+        l_board.m_start = now_ns();
+        if ( connect( l_board.m_fd, ( const sockaddr * ) &l_board.m_addr, sizeof( l_board.m_addr ) ) < 0 &&
+             errno != EINPROGRESS )
+        {
+            log_msg( LOG_INFO, "[%s] unable to connect.", l_board.m_label );
+            fleet_close( l_board, s_casts );
+            continue;
+        }
+        l_board.m_state = LOAD_CONNECTING;
+        l_connecting++;
+    }
+
+    log_msg( LOG_INFO, "Fleet of %d boards, commands from stdin go to all, '%s' to close.", l_count, STR_CLOSE );
+
+    // stdin is polled, so it may be also a script file
+    pollfd *l_poll = new pollfd[ l_count + 1 ];
+    char l_input[ 4096 ];
+    int l_input_len = 0;
+    bool l_stdin = true, l_setup = true;
+    long l_next_id = 0, l_oldest = 0;
+
+    while ( !g_stop )
+    {
+        uint64_t l_now = now_ns();
+
+        // timeouts of connects and broadcasts
+        for ( int b = 0; b < l_count; b++ )
+            if ( l_boards[ b ].m_state == LOAD_CONNECTING && l_now - l_boards[ b ].m_start > FLEET_CONNECT_TOUT_NS )
+            {
+                log_msg( LOG_INFO, "[%s] connect timeout.", l_boards[ b ].m_label );
+                fleet_close( l_boards[ b ], s_casts );
+                l_connecting--;
+            }
+
+        if ( l_setup && !l_connecting )
+        {
+            int l_open = 0;
+            for ( int b = 0; b < l_count; b++ ) l_open += l_boards[ b ].m_state == LOAD_OPEN;
+            log_msg( LOG_INFO, "Fleet connected: %d of %d boards in %.3f ms.", l_open, l_count, ( l_now - l_start ) / 1e6 );
+            l_setup = false;
+        }
+
+        for ( ; l_oldest < l_next_id; l_oldest++ )
+        {
+            FleetCast &l_cast = s_casts[ l_oldest % FLEET_CASTS ];
+            if ( !l_cast.m_done && l_cast.m_replies + l_cast.m_lost >= l_cast.m_sent )
+                fleet_done( l_cast, l_boards, l_count, s_skew, false );
+            else if ( !l_cast.m_done && l_now - l_cast.m_start > LAT_TOUT_NS )
+                fleet_done( l_cast, l_boards, l_count, s_skew, true );
+            if ( !l_cast.m_done ) break;
+        }
+
+        // complete lines are broadcast after connects, new broadcast needs free slot
+        char *l_eol;
+        while ( !l_setup && l_next_id - l_oldest < FLEET_CASTS &&
+                ( l_eol = ( char * ) memchr( l_input, '\n', l_input_len ) ) )
+        {
+            int l_line_len = l_eol - l_input + 1;
+            *l_eol = '\0';
+            l_input[ strcspn( l_input, "\r" ) ] = '\0';
+
+            if ( !strncasecmp( l_input, STR_CLOSE, strlen( STR_CLOSE ) ) )
+            {
+                l_stdin = false;
+                l_input_len = 0;
+                break;
+            }
+            // board drops longer line without echo
+            if ( strlen( l_input ) > LED_LINE_MAX )
+                log_msg( LOG_INFO, "Line longer than %d characters is not sent.", LED_LINE_MAX );
+            else if ( *l_input )
+                fleet_cast( l_boards, l_count, s_casts, l_next_id++, l_input );
+
+            l_input_len -= l_line_len;
+            memmove( l_input, l_input + l_line_len, l_input_len );
+        }
+
+        bool l_line = memchr( l_input, '\n', l_input_len ) != nullptr;
+        if ( !l_line && l_input_len == ( int ) sizeof( l_input ) )
+        {
+            log_msg( LOG_INFO, "Too long line from stdin is dropped." );
+            l_input_len = 0;
+        }
+
+        // end of stdin, wait for the last replies
+        if ( !l_stdin && !l_line && l_oldest == l_next_id ) break;
+
+        bool l_read_stdin = l_stdin && !l_line;
+        l_poll[ 0 ] = { l_read_stdin ? STDIN_FILENO : -1, POLLIN, 0 };
+        for ( int b = 0; b < l_count; b++ )
+        {
+            FleetBoard &l_board = l_boards[ b ];
+            short l_events = l_board.m_state == LOAD_CONNECTING || l_board.m_out_len ? POLLOUT : 0;
+            if ( l_board.m_state != LOAD_CONNECTING ) l_events |= POLLIN;
+            l_poll[ b + 1 ] = { l_board.m_fd, l_events, 0 };
+        }
+
+        if ( poll( l_poll, l_count + 1, 100 ) < 0 )
+        {
+            if ( errno == EINTR ) continue;
+            log_msg( LOG_ERROR, "Function poll failed!" );
             break;
+        }
+
+        for ( int b = 0; b < l_count; b++ )
+        {
+            FleetBoard &l_board = l_boards[ b ];
+            short l_what = l_poll[ b + 1 ].revents;
+            if ( !l_what || l_board.m_fd < 0 ) continue;
+
+            if ( l_board.m_state == LOAD_CONNECTING )
+            {
+                int l_err = 0;
+                socklen_t l_err_len = sizeof( l_err );
+                getsockopt( l_board.m_fd, SOL_SOCKET, SO_ERROR, &l_err, &l_err_len );
+                l_connecting--;
+                if ( l_err )
+                {
+                    log_msg( LOG_INFO, "[%s] unable to connect: %s.", l_board.m_label, strerror( l_err ) );
+                    fleet_close( l_board, s_casts );
+                    continue;
+                }
+                l_board.m_state = LOAD_OPEN;
+                log_msg( LOG_DEBUG, "[%s] connected in %.3f ms.", l_board.m_label, ( now_ns() - l_board.m_start ) / 1e6 );
+                continue;
+            }
+
+            if ( l_what & ( POLLIN | POLLHUP | POLLERR ) )
+                fleet_read( l_boards, b, s_casts );
+            if ( l_board.m_state == LOAD_OPEN && ( l_what & POLLOUT ) && !fleet_flush( l_board ) )
+            {
+                log_msg( LOG_INFO, "[%s] unable to send, connection closed.", l_board.m_label );
+                fleet_close( l_board, s_casts );
+            }
+        }
+
+        if ( l_poll[ 0 ].revents & ( POLLIN | POLLHUP ) )
+        {
+            int l_len = read( STDIN_FILENO, l_input + l_input_len, sizeof( l_input ) - l_input_len );
+            if ( l_len > 0 )
+                l_input_len += l_len;
+            else
+            {
+                // the last line without '\n'
+                l_stdin = false;
+                if ( l_input_len && l_input_len < ( int ) sizeof( l_input ) ) l_input[ l_input_len++ ] = '\n';
+            }
+        }
     }
+
+    int l_open = 0;
+    long l_replies = 0;
+    for ( int b = 0; b < l_count; b++ )
+    {
+        l_open += l_boards[ b ].m_state == LOAD_OPEN;
+        l_replies += l_boards[ b ].m_replies;
+        if ( l_boards[ b ].m_fd >= 0 ) close( l_boards[ b ].m_fd );
+    }
+    delete [] l_poll;
+    free( l_boards );
+
+    log_msg( LOG_INFO, "Fleet: %d of %d boards open, %ld broadcasts, %ld replies.", l_open, l_count, l_next_id, l_replies );
+    s_skew.print( "Skew" );
+    return 0;
 }
 
 //***************************************************************************
-// help
+// interactive mode
 
-void help( int t_narg, char **t_args )
+#define RX_RING_SIZE            ( 64 * 1024 )
+
+// Frames or lines complete in ring are used in place.
+// Returns -1 for line STR_CLOSE.
+int rx_process( MirrorRing &t_ring, bool t_binary, ButtonRecorder &t_rec )
 {
-    if ( t_narg <= 1 || !strcmp( t_args[ 1 ], "-h" ) )
+    static uint8_t s_pressed = 0;   // previous text state
+
+    while ( 1 )
     {
-        printf(
-                "\n"
-                "  Socket client example.\n"
-                "\n"
-                "  Use: %s [-h -d] ip_or_name port_number\n"
-                "\n"
-                "    -d  debug mode \n"
-                "    -h  this help\n"
-                "\n", t_args[ 0 ] );
+        const uint8_t *l_data = t_ring.read_ptr();
+        size_t l_len = t_ring.read_len();
 
-        exit( 0 );
-    }
+        if ( t_binary )
+        {
+            size_t l_size = lp_frame_size( l_data, l_len );
+            if ( !l_size ) return 0;
 
-    if ( !strcmp( t_args[ 1 ], "-d" ) )
-        g_debug = LOG_DEBUG;
+            uint16_t l_arg = lp_frame_arg( l_data );
+            if ( l_data[ 0 ] == LP_OP_BUTTONS && t_rec.is_open() )
+                t_rec.add( l_arg & 0xFF, l_arg >> 8 );
+            else
+                bin_print( l_data );
+            t_ring.consume( l_size );
+            continue;
+        }
+
+        const uint8_t *l_eol = ( const uint8_t * ) memchr( l_data, '\n', l_len );
+        if ( !l_eol )
+        {
+            // line longer than ring is displayed as it is
+            if ( !t_ring.write_space() )
+            {
+                if ( write( STDOUT_FILENO, l_data, l_len ) < 0 )
+                    log_msg( LOG_ERROR, "Unable to write to stdout." );
+                t_ring.consume( l_len );
+            }
+            return 0;
+        }
+
+        size_t l_line = l_eol - l_data + 1;
+
+        // zero after previous button line is not displayed
+        const char *l_text = ( const char * ) l_data;
+        int l_text_len = l_line;
+        LineKind l_kind = line_kind( l_text, l_text_len );
+
+        if ( t_rec.is_open() && l_kind == LINE_BUTTONS )
+        {
+            uint8_t l_pressed = 0;
+            for ( int i = 4; i < l_text_len && i < 12 && ( l_text[ i ] == '0' || l_text[ i ] == '1' ); i++ )
+                if ( l_text[ i ] == '1' ) l_pressed |= 1 << ( i - 4 );
+            t_rec.add( l_pressed, l_pressed ^ s_pressed );
+            s_pressed = l_pressed;
+        }
+        else if ( write( STDOUT_FILENO, l_text, l_text_len ) < 0 )
+            log_msg( LOG_ERROR, "Unable to write to stdout." );
+
+        // request to close?
+        bool l_close = l_text_len > ( int ) strlen( STR_CLOSE ) &&
+                !strncasecmp( l_text, STR_CLOSE, strlen( STR_CLOSE ) );
+        t_ring.consume( l_line );
+        if ( l_close ) return -1;
+    }
 }
 
 //***************************************************************************
@@ -102,16 +1864,80 @@ int main( int t_narg, char **t_args )
 
     int l_port = 0;
     char *l_host = nullptr;
+    bool l_binary = false;
+    bool l_load = false;
+    LoadConfig l_load_cfg;
+    bool l_latency = false;
+    LatConfig l_lat_cfg;
+    ReplayConfig l_replay_cfg;
+    const char *l_record = nullptr;
+    const char *l_fleet = nullptr;
 
     // parsing arguments
     for ( int i = 1; i < t_narg; i++ )
     {
+        if ( !strcmp( t_args[ i ], "--nodelay" ) )
+        {
+            l_lat_cfg.m_nodelay = true;
+            continue;
+        }
+
+        // options with value
+        if ( !strncmp( t_args[ i ], "--", 2 ) && i + 1 < t_narg )
+        {
+            const char *l_opt = t_args[ i ] + 2;
+            const char *l_val = t_args[ ++i ];
+
+            if ( !strcmp( l_opt, "load" ) )
+            {
+                l_load = true;
+                l_load_cfg.m_conns = atoi( l_val );
+            }
+            else if ( !strcmp( l_opt, "rate" ) )
+                l_load_cfg.m_rate = atof( l_val );
+            else if ( !strcmp( l_opt, "time" ) )
+                l_load_cfg.m_time = atof( l_val );
+            else if ( !strcmp( l_opt, "window" ) )
+                l_load_cfg.m_window = MIN( LOAD_WINDOW_MAX, MAX( 1, atoi( l_val ) ) );
+            else if ( !strcmp( l_opt, "mix" ) )
+                load_mix( l_load_cfg, l_val );
+            else if ( !strcmp( l_opt, "latency" ) )
+            {
+                l_latency = true;
+                l_lat_cfg.m_count = atol( l_val );
+            }
+            else if ( !strcmp( l_opt, "interval" ) )
+                l_lat_cfg.m_interval = atof( l_val );
+            else if ( !strcmp( l_opt, "report" ) )
+                l_lat_cfg.m_report = atof( l_val ) > 0 ? atof( l_val ) : 1;
+            else if ( !strcmp( l_opt, "csv" ) )
+                l_lat_cfg.m_csv = l_val;
+            else if ( !strcmp( l_opt, "replay" ) )
+                l_replay_cfg.m_script = l_val;
+            else if ( !strcmp( l_opt, "speed" ) )
+                l_replay_cfg.m_speed = atof( l_val );
+            else if ( !strcmp( l_opt, "out" ) )
+                l_replay_cfg.m_out = l_val;
+            else if ( !strcmp( l_opt, "record" ) )
+                l_record = l_val;
+            else if ( !strcmp( l_opt, "dump" ) )
+                exit( rec_dump( l_val ) );
+            else if ( !strcmp( l_opt, "fleet" ) )
+                l_fleet = l_val;
+            else
+                log_msg( LOG_INFO, "Unknown option '%s'.", t_args[ i - 1 ] );
+            continue;
+        }
+
         if ( !strcmp( t_args[ i ], "-d" ) )
             g_debug = LOG_DEBUG;
 
         if ( !strcmp( t_args[ i ], "-h" ) )
             help( t_narg, t_args );
 
+        if ( !strcmp( t_args[ i ], "-b" ) )
+            l_binary = true;
+
         if ( *t_args[ i ] != '-' )
         {
             if ( !l_host )
@@ -121,6 +1947,9 @@ int main( int t_narg, char **t_args )
         }
     }
 
+    if ( l_fleet )
+        return fleet_run( l_fleet );
+
     if ( !l_host || !l_port )
     {
         log_msg( LOG_INFO, "Host or port is missing!" );
@@ -146,6 +1975,9 @@ int main( int t_narg, char **t_args )
     l_cl_addr.sin_port = htons( l_port );
     freeaddrinfo( l_ai_ans );
 
+    if ( l_load )
+        return load_run( l_cl_addr, l_load_cfg );
+
     // socket creation
     int l_sock_server = socket( AF_INET, SOCK_STREAM, 0 );
     if ( l_sock_server == -1 )
@@ -171,6 +2003,48 @@ int main( int t_narg, char **t_args )
     log_msg( LOG_INFO, "Server IP: '%s'  port: %d",
              inet_ntoa( l_cl_addr.sin_addr ), ntohs( l_cl_addr.sin_port ) );
 
+    if ( l_latency )
+    {
+        int l_ret = lat_run( l_sock_server, l_lat_cfg );
+        close( l_sock_server );
+        return l_ret;
+    }
+
+    if ( l_replay_cfg.m_script )
+    {
+        int l_ret = replay_run( l_sock_server, l_replay_cfg );
+        close( l_sock_server );
+        return l_ret;
+    }
+
+    MirrorRing l_ring;
+    if ( !l_ring.init( RX_RING_SIZE ) )
+    {
+        log_msg( LOG_ERROR, "Unable to map receive ring." );
+        exit( 1 );
+    }
+
+    ButtonRecorder l_recorder;
+    if ( l_record )
+    {
+        if ( !l_recorder.open( l_record ) )
+        {
+            log_msg( LOG_ERROR, "Unable to open '%s'.", l_record );
+            exit( 1 );
+        }
+        log_msg( LOG_INFO, "Button states are recorded to '%s'.", l_record );
+    }
+
+    if ( l_binary )
+    {
+        if ( bin_negotiate( l_sock_server ) < 0 )
+        {
+            log_msg( LOG_ERROR, "Server does not support binary protocol." );
+            exit( 1 );
+        }
+        log_msg( LOG_INFO, "Binary protocol, enter -h to see commands." );
+    }
+
     log_msg( LOG_INFO, "Enter 'close' to close application." );
 
     // list of fd sources
@@ -181,13 +2055,22 @@ int main( int t_narg, char **t_args )
     l_read_poll[ 1 ].fd = l_sock_server;
     l_read_poll[ 1 ].events = POLLIN;
 
+    // Ctrl+C interrupts poll and recording is closed below
+    signal( SIGINT, stop_handler );
+    signal( SIGTERM, stop_handler );
+
     // go!
-    while ( 1 )
+    while ( !g_stop )
     {
         char l_buf[ 128 ];
 
-        // select from fds
-        if ( poll( l_read_poll, 2, -1 ) < 0 ) break;
+        // select from fds, recorder is flushed at least every second
+        if ( poll( l_read_poll, 2, l_recorder.is_open() ? REC_FLUSH_NS / 1000000 : -1 ) < 0 )
+        {
+            if ( errno != EINTR ) log_msg( LOG_ERROR, "Function poll failed!" );
+            break;
+        }
+        l_recorder.flush_due();
 
         // data on stdin?
         if ( l_read_poll[ 0 ].revents & POLLIN )
@@ -199,6 +2082,19 @@ int main( int t_narg, char **t_args )
             else
                 log_msg( LOG_DEBUG, "Read %d bytes from stdin.", l_len );
 
+            // end of stdin, e.g. recording in background
+            if ( !l_len )
+            {
+                l_read_poll[ 0 ].fd = -1;
+                continue;
+            }
+
+            if ( l_binary && l_len > 0 )
+            {
+                if ( bin_stdin( l_sock_server, l_buf, l_len ) < 0 ) break;
+                continue;
+            }
+
             // send data to server
             l_len = write( l_sock_server, l_buf, l_len );
             if ( l_len < 0 )
@@ -208,10 +2104,10 @@ int main( int t_narg, char **t_args )
         }
 
         // data from server?
-        if ( l_read_poll[ 1 ].revents & POLLIN )
+        if ( l_read_poll[ 1 ].revents & ( POLLIN | POLLHUP | POLLERR ) )
         {
-            // read data from server
-            int l_len = read( l_sock_server, l_buf, sizeof( l_buf ) );
+            // read data from server directly into ring
+            int l_len = read( l_sock_server, l_ring.write_ptr(), l_ring.write_space() );
             if ( !l_len )
             {
                 log_msg( LOG_DEBUG, "Server closed socket." );
@@ -225,13 +2121,10 @@ int main( int t_narg, char **t_args )
             else
                 log_msg( LOG_DEBUG, "Read %d bytes from server.", l_len );
 
-            // display on stdout
-            l_len = write( STDOUT_FILENO, l_buf, l_len );
-            if ( l_len < 0 )
-                log_msg( LOG_ERROR, "Unable to write to stdout." );
+            l_ring.commit( l_len );
 
-            // request to close?
-            if ( !strncasecmp( l_buf, STR_CLOSE, strlen( STR_CLOSE ) ) )
+            // close may be any line, not only start of read
+            if ( rx_process( l_ring, l_binary, l_recorder ) < 0 )
             {
                 log_msg( LOG_INFO, "Connection will be closed..." );
                 break;
@@ -242,5 +2135,12 @@ int main( int t_narg, char **t_args )
     // close socket
     close( l_sock_server );
 
+    if ( l_recorder.is_open() )
+    {
+        l_recorder.close();
+        log_msg( LOG_INFO, "Recorded %lu button states, %lu bytes.",
+                 ( unsigned long ) l_recorder.records(), ( unsigned long ) l_recorder.bytes() );
+    }
+
     return 0;
 }
\ No newline at end of file
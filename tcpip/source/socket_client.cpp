@@ -0,0 +1,342 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Socket client reconnecting to server
+//
+// **************************************************************************
+//
+// FreeRTOS kernel includes.
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+// System includes.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "fsl_debug_console.h"
+#include "socket_client.h"
+#include "socket_profile.h"
+#include "static_alloc.h"
+
+#define TASK_NAME_SOCKET_CLIENT		"socket_client"
+
+#define SC_PING						"PING "
+#define SC_BUTTONS					"BTN "
+
+struct ScMsg
+{
+	uint8_t m_len;
+	char m_data[ SOCKET_CLIENT_MSG_SIZE ];
+};
+
+static struct freertos_sockaddr g_sc_addr;
+static QueueHandle_t g_sc_queue = NULL;
+static SemaphoreHandle_t g_sc_wake = NULL;		// given by socket events and SocketClientSend()
+static SocketClientStats g_sc_stats;
+static TickType_t g_sc_since;					// start of current connection
+
+// Ring of client task, lines from head are sent and wait for echo
+static ScMsg g_sc_ring[ SOCKET_CLIENT_RING ];
+static uint32_t g_sc_head = 0;
+static uint32_t g_sc_count = 0;
+static uint32_t g_sc_sent = 0;
+static uint32_t g_sc_skip = 0;					// echoes of dropped lines
+
+static void sc_state( SocketClientState t_state )
+{
+	taskENTER_CRITICAL();
+	g_sc_stats.m_state = t_state;
+	taskEXIT_CRITICAL();
+}
+
+static void sc_count( uint32_t *t_counter )
+{
+	taskENTER_CRITICAL();
+	( *t_counter )++;
+	taskEXIT_CRITICAL();
+}
+
+// Line with button state, line need not be terminated
+static bool sc_is_buttons( const char *t_line, uint32_t t_len )
+{
+	return t_len >= strlen( SC_BUTTONS ) && !strncmp( t_line, SC_BUTTONS, strlen( SC_BUTTONS ) );
+}
+
+// Move queued lines into ring, the oldest line is dropped when ring is full
+static void sc_take_queue()
+{
+	ScMsg l_msg;
+
+	while ( xQueueReceive( g_sc_queue, &l_msg, 0 ) == pdPASS )
+	{
+		if ( g_sc_count == SOCKET_CLIENT_RING )
+		{
+			if ( g_sc_sent )
+			{
+				// its echo may still come, echo of button line is not counted
+				if ( !sc_is_buttons( g_sc_ring[ g_sc_head ].m_data, g_sc_ring[ g_sc_head ].m_len ) )
+					g_sc_skip++;
+				g_sc_sent--;
+			}
+			g_sc_head = ( g_sc_head + 1 ) % SOCKET_CLIENT_RING;
+			g_sc_count--;
+			sc_count( &g_sc_stats.m_dropped );
+		}
+		g_sc_ring[ ( g_sc_head + g_sc_count ) % SOCKET_CLIENT_RING ] = l_msg;
+		g_sc_count++;
+	}
+}
+
+// Line t_line without its '\n' received, echo of sent line need not be sent
+// again. Parser ends line on '\0', so zeros after server's button lines never
+// get here. Server broadcasts button state in the same form as button lines
+// sent to it, so button line is echo only when it equals the oldest sent line.
+static void sc_echo( const char *t_line, uint32_t t_len )
+{
+	if ( sc_is_buttons( t_line, t_len ) )
+	{
+		const ScMsg *l_msg = &g_sc_ring[ g_sc_head ];
+
+		// echoes of dropped lines come first
+		if ( g_sc_skip || !g_sc_sent || l_msg->m_len != t_len + 1 || memcmp( l_msg->m_data, t_line, t_len ) )
+			return;
+	}
+
+	if ( g_sc_skip )
+	{
+		g_sc_skip--;
+	}
+	else if ( g_sc_sent )
+	{
+		g_sc_head = ( g_sc_head + 1 ) % SOCKET_CLIENT_RING;
+		g_sc_count--;
+		g_sc_sent--;
+	}
+}
+
+static void sc_report()
+{
+	SocketClientStats l_stats;
+	SocketClientGetStats( &l_stats );
+
+	PRINTF( "SC up %u reconnects %u sent %u resent %u dropped %u rtt %u %u %u us\r\n",
+			l_stats.m_uptime_ms, l_stats.m_reconnects, l_stats.m_sent, l_stats.m_resent, l_stats.m_dropped,
+			l_stats.m_rtt_us, l_stats.m_rtt_min_us, l_stats.m_rtt_max_us );
+}
+
+// Serve connected socket, returns when connection is lost
+static void sc_connected( Socket_t t_sock )
+{
+	LedLineParser l_parser;
+	uint8_t l_rx_buf[ 64 ];
+	uint32_t l_cycles_us = SystemCoreClock / 1000000;
+	uint32_t l_ping_seq = 0, l_ping_start = 0;
+	bool l_ping_wait = false;
+	TickType_t l_ping_time = xTaskGetTickCount() - pdMS_TO_TICKS( SOCKET_CLIENT_PING_MS );
+
+	while ( 1 )
+	{
+		sc_take_queue();
+
+		// only whole lines, so ping never splits line
+		while ( g_sc_sent < g_sc_count )
+		{
+			ScMsg *l_msg = &g_sc_ring[ ( g_sc_head + g_sc_sent ) % SOCKET_CLIENT_RING ];
+			if ( FreeRTOS_tx_space( t_sock ) < ( BaseType_t ) l_msg->m_len ) break;
+			if ( FreeRTOS_send( t_sock, l_msg->m_data, l_msg->m_len, FREERTOS_MSG_DONTWAIT ) != l_msg->m_len ) return;
+			g_sc_sent++;
+			sc_count( &g_sc_stats.m_sent );
+		}
+
+		TickType_t l_now = xTaskGetTickCount();
+
+		if ( l_ping_wait && l_now - l_ping_time >= pdMS_TO_TICKS( SOCKET_CLIENT_PING_TOUT_MS ) )
+		{
+			PRINTF( "SC no echo of ping %u.\r\n", l_ping_seq );
+			return;
+		}
+
+		if ( !l_ping_wait && l_now - l_ping_time >= pdMS_TO_TICKS( SOCKET_CLIENT_PING_MS ) )
+		{
+			char l_ping[ 16 ];
+			int l_len = snprintf( l_ping, sizeof( l_ping ), SC_PING "%u\n", ( unsigned ) l_ping_seq + 1 );
+
+			if ( FreeRTOS_tx_space( t_sock ) >= l_len )
+			{
+				l_ping_start = portGET_RUN_TIME_COUNTER_VALUE();
+				if ( FreeRTOS_send( t_sock, l_ping, l_len, FREERTOS_MSG_DONTWAIT ) != l_len ) return;
+				l_ping_seq++;
+				l_ping_wait = true;
+				l_ping_time = l_now;
+			}
+		}
+
+		BaseType_t l_len;
+		while ( ( l_len = FreeRTOS_recv( t_sock, l_rx_buf, sizeof( l_rx_buf ), FREERTOS_MSG_DONTWAIT ) ) > 0 )
+		{
+			l_parser.feed( l_rx_buf, l_len,
+				[&]( const char *tp_line, uint32_t tp_len, bool, Direction_t, int )
+				{
+					if ( tp_len <= strlen( SC_PING ) || strncmp( tp_line, SC_PING, strlen( SC_PING ) ) )
+					{
+						sc_echo( tp_line, tp_len );
+						return true;
+					}
+
+					// line is terminated by end of line, strtoul stops there
+					if ( !l_ping_wait || strtoul( tp_line + strlen( SC_PING ), NULL, 10 ) != l_ping_seq )
+						return true;
+
+					uint32_t l_us = ( portGET_RUN_TIME_COUNTER_VALUE() - l_ping_start ) / l_cycles_us;
+					l_ping_wait = false;
+
+					taskENTER_CRITICAL();
+					g_sc_stats.m_rtt_us = l_us;
+					if ( l_us < g_sc_stats.m_rtt_min_us ) g_sc_stats.m_rtt_min_us = l_us;
+					if ( l_us > g_sc_stats.m_rtt_max_us ) g_sc_stats.m_rtt_max_us = l_us;
+					taskEXIT_CRITICAL();
+
+					if ( l_ping_seq % SOCKET_CLIENT_REPORT_PINGS == 0 ) sc_report();
+					return true;
+				} );
+		}
+
+		// closed by server or by stack
+		if ( l_len < 0 ) return;
+
+		// sleep until socket event, new line or ping time
+		TickType_t l_next = l_ping_time + pdMS_TO_TICKS( l_ping_wait ? SOCKET_CLIENT_PING_TOUT_MS : SOCKET_CLIENT_PING_MS );
+		TickType_t l_wait = l_next - xTaskGetTickCount();
+		if ( ( int32_t ) l_wait > 0 )
+			xSemaphoreTake( g_sc_wake, l_wait );
+	}
+}
+
+void task_socket_client( void *t_arg )
+{
+	TickType_t l_conn_tout = pdMS_TO_TICKS( SOCKET_CLIENT_CONNECT_TOUT_MS );
+	TickType_t l_no_wait = 0;
+	uint32_t l_backoff_ms = 0;
+
+	while ( 1 )
+	{
+		if ( !FreeRTOS_IsNetworkUp() )
+		{
+			sc_state( SC_WAIT_NETWORK );
+			vTaskDelay( pdMS_TO_TICKS( SOCKET_CLIENT_BACKOFF_MIN_MS ) );
+			sc_take_queue();
+			continue;
+		}
+
+		if ( l_backoff_ms )
+		{
+			sc_state( SC_BACKOFF );
+			vTaskDelay( pdMS_TO_TICKS( l_backoff_ms ) );
+			sc_take_queue();
+		}
+
+		sc_state( SC_CONNECTING );
+
+		Socket_t l_sock = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+		if ( l_sock == FREERTOS_INVALID_SOCKET )
+		{
+			l_backoff_ms = SOCKET_CLIENT_BACKOFF_MAX_MS;
+			continue;
+		}
+
+		// FreeRTOS_connect waits for receive timeout, then socket is used without waiting
+		socket_option( l_sock, FREERTOS_SO_RCVTIMEO, l_conn_tout );
+		socket_option( l_sock, FREERTOS_SO_SET_SEMAPHORE, g_sc_wake );
+		SocketProfileApply( l_sock, SOCK_PROFILE_LOW_LATENCY );
+
+		if ( FreeRTOS_connect( l_sock, &g_sc_addr, sizeof( g_sc_addr ) ) != 0 )
+		{
+			FreeRTOS_closesocket( l_sock );
+			sc_count( &g_sc_stats.m_failures );
+
+			l_backoff_ms = l_backoff_ms ? l_backoff_ms * 2 : SOCKET_CLIENT_BACKOFF_MIN_MS;
+			if ( l_backoff_ms > SOCKET_CLIENT_BACKOFF_MAX_MS ) l_backoff_ms = SOCKET_CLIENT_BACKOFF_MAX_MS;
+
+			PRINTF( "SC unable to connect, next try in %u ms.\r\n", l_backoff_ms );
+			continue;
+		}
+
+		l_backoff_ms = 0;
+		socket_option( l_sock, FREERTOS_SO_RCVTIMEO, l_no_wait );
+
+		// lines without echo are sent again
+		taskENTER_CRITICAL();
+		g_sc_stats.m_state = SC_CONNECTED;
+		if ( g_sc_stats.m_connects++ ) g_sc_stats.m_reconnects++;
+		g_sc_stats.m_resent += g_sc_sent;
+		g_sc_since = xTaskGetTickCount();
+		taskEXIT_CRITICAL();
+
+		PRINTF( "SC connected, %u lines sent again.\r\n", g_sc_sent );
+		g_sc_sent = 0;
+		g_sc_skip = 0;
+
+		sc_connected( l_sock );
+
+		sc_state( SC_BACKOFF );
+		PRINTF( "SC connection lost after %u ms.\r\n",
+				( unsigned ) ( ( xTaskGetTickCount() - g_sc_since ) * portTICK_PERIOD_MS ) );
+
+		FreeRTOS_shutdown( l_sock, FREERTOS_SHUT_RDWR );
+		FreeRTOS_closesocket( l_sock );
+	}
+}
+
+// Create client task connecting to t_addr
+void SocketClientInit( const struct freertos_sockaddr *t_addr, UBaseType_t t_priority )
+{
+	g_sc_addr = *t_addr;
+	g_sc_stats.m_rtt_min_us = UINT32_MAX;
+	g_sc_queue = APP_QUEUE_CREATE( socket_client, SOCKET_CLIENT_QUEUE_LEN, sizeof( ScMsg ) );
+	g_sc_wake = APP_SEMAPHORE_CREATE_BINARY( socket_client );
+
+	if ( APP_TASK_CREATE( task_socket_client, TASK_NAME_SOCKET_CLIENT, configMINIMAL_STACK_SIZE + 400,
+			NULL, t_priority, NULL ) != pdPASS )
+	{
+		PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_SOCKET_CLIENT );
+	}
+}
+
+// Queue one line without waiting
+bool SocketClientSend( const char *t_line, size_t t_len )
+{
+	ScMsg l_msg;
+
+	if ( !g_sc_queue || !t_len || t_len > SOCKET_CLIENT_MSG_SIZE || t_line[ t_len - 1 ] != '\n' ) return false;
+
+	l_msg.m_len = t_len;
+	memcpy( l_msg.m_data, t_line, t_len );
+
+	if ( xQueueSend( g_sc_queue, &l_msg, 0 ) != pdPASS )
+	{
+		sc_count( &g_sc_stats.m_dropped );
+		return false;
+	}
+
+	xSemaphoreGive( g_sc_wake );
+	return true;
+}
+
+// Copy of statistics
+void SocketClientGetStats( SocketClientStats *t_stats )
+{
+	taskENTER_CRITICAL();
+	*t_stats = g_sc_stats;
+	if ( t_stats->m_state == SC_CONNECTED )
+		t_stats->m_uptime_ms = ( xTaskGetTickCount() - g_sc_since ) * portTICK_PERIOD_MS;
+	else
+		t_stats->m_uptime_ms = 0;
+	taskEXIT_CRITICAL();
+}
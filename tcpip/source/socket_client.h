@@ -0,0 +1,91 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Socket client reconnecting to server
+//
+// **************************************************************************
+//
+// One task keeps connection to server. Other tasks only queue lines by
+// SocketClientSend(), they never wait for network. Client task moves lines
+// into its ring and sends them when connection is up.
+//
+// Server must echo every line, as socket server of this program does.
+// Sent line stays in ring until its echo is received, so after reconnect
+// all lines without echo are sent again. When ring is full, the oldest
+// line is dropped. "BTN xxxx" lines broadcast by server are not echoes,
+// unless they equal the oldest line waiting for echo.
+//
+// Every SOCKET_CLIENT_PING_MS line "PING <n>" is sent and its echo gives
+// round trip time. Without echo in SOCKET_CLIENT_PING_TOUT_MS connection
+// is dead, keep-alive of TCP stack would find it much later. Connection
+// closed by stack (reset, keep-alive, hang protection) is found by
+// FreeRTOS_recv() immediately.
+//
+// First reconnect is immediate, next ones wait SOCKET_CLIENT_BACKOFF_MIN_MS
+// doubled after every failure up to SOCKET_CLIENT_BACKOFF_MAX_MS.
+//
+// States are printed, connection prints statistics every
+// SOCKET_CLIENT_REPORT_PINGS pings:
+//
+// SC up <ms> reconnects <n> sent <lines> resent <lines> dropped <lines> rtt <last> <min> <max> us
+
+#ifndef SOCKET_CLIENT_H
+#define SOCKET_CLIENT_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+#include "led_command.h"
+
+// Line with its '\n', longer line would not be echoed
+#define SOCKET_CLIENT_MSG_SIZE			( LED_LINE_MAX + 1 )
+#define SOCKET_CLIENT_QUEUE_LEN			8
+#define SOCKET_CLIENT_RING				16
+
+#define SOCKET_CLIENT_CONNECT_TOUT_MS	1000
+#define SOCKET_CLIENT_BACKOFF_MIN_MS	20
+#define SOCKET_CLIENT_BACKOFF_MAX_MS	5000
+#define SOCKET_CLIENT_PING_MS			1000
+#define SOCKET_CLIENT_PING_TOUT_MS		3000
+#define SOCKET_CLIENT_REPORT_PINGS		10
+
+enum SocketClientState
+{
+	SC_WAIT_NETWORK,
+	SC_CONNECTING,
+	SC_CONNECTED,
+	SC_BACKOFF
+};
+
+struct SocketClientStats
+{
+	SocketClientState m_state;
+	uint32_t m_connects;
+	uint32_t m_reconnects;
+	uint32_t m_failures;					// unsuccessful connects
+	uint32_t m_uptime_ms;					// of current connection
+	uint32_t m_sent;						// lines
+	uint32_t m_resent;
+	uint32_t m_dropped;
+	uint32_t m_rtt_us;						// the last ping
+	uint32_t m_rtt_min_us;
+	uint32_t m_rtt_max_us;
+};
+
+// Create client task connecting to t_addr
+void SocketClientInit( const struct freertos_sockaddr *t_addr, UBaseType_t t_priority );
+
+// Queue one line ending with '\n', may be called by any task, false if dropped
+bool SocketClientSend( const char *t_line, size_t t_len );
+
+// Copy of statistics
+void SocketClientGetStats( SocketClientStats *t_stats );
+
+#endif // SOCKET_CLIENT_H
@@ -0,0 +1,188 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Named buffer and window profiles of TCP sockets
+//
+// **************************************************************************
+//
+// FreeRTOS kernel includes.
+#include "FreeRTOS.h"
+#include "task.h"
+
+// System includes.
+#include <cstring>
+#include "fsl_debug_console.h"
+#include "FreeRTOS_Stream_Buffer.h"
+#include "socket_profile.h"
+#include "static_alloc.h"
+
+#define TASK_NAME_SOCKET_BENCH	"socket_bench"
+
+#define SOCK_BENCH_CHUNK		256
+#define SOCK_BENCH_TOUT_MS		2000
+
+static const SocketProfile g_sock_profiles[ SOCK_PROFILE_COUNT ] =
+{
+	{ "low-latency", ipconfigTCP_MSS, 1, ipconfigTCP_MSS, 1 },
+	{ "bulk", 4 * ipconfigTCP_MSS, 4, 4 * ipconfigTCP_MSS, 4 },
+	{ "min-ram", 256, 2, 256, 2 },
+};
+
+static struct freertos_sockaddr g_sock_bench_addr;
+
+// Parameters of profile
+const SocketProfile *SocketProfileGet( SocketProfileId t_id )
+{
+	return &g_sock_profiles[ t_id ];
+}
+
+// Apply profile to socket
+BaseType_t SocketProfileApply( Socket_t t_socket, SocketProfileId t_id )
+{
+	const SocketProfile *l_prof = &g_sock_profiles[ t_id ];
+	WinProperties_t l_win_props;
+
+	memset( &l_win_props, '\0', sizeof l_win_props );
+	l_win_props.lTxBufSize = l_prof->m_tx_buf;
+	l_win_props.lTxWinSize = l_prof->m_tx_win;
+	l_win_props.lRxBufSize = l_prof->m_rx_buf;
+	l_win_props.lRxWinSize = l_prof->m_rx_win;
+	return socket_option( t_socket, FREERTOS_SO_WIN_PROPERTIES, l_win_props );
+}
+
+// One stream buffer as allocated by prvTCPCreateStream()
+static size_t socket_stream_ram( size_t t_len )
+{
+	t_len = ( t_len + sizeof( size_t ) ) & ~( sizeof( size_t ) - 1U );
+	return sizeof( StreamBuffer_t ) - sizeof( ( ( StreamBuffer_t * ) 0 )->ucArray ) + t_len;
+}
+
+// Heap used by stream buffers of one socket with profile
+size_t SocketProfileRam( SocketProfileId t_id )
+{
+	const SocketProfile *l_prof = &g_sock_profiles[ t_id ];
+	size_t l_tx = FreeRTOS_round_up( l_prof->m_tx_buf, ipconfigTCP_MSS );
+
+	return socket_stream_ram( l_tx ) + socket_stream_ram( l_prof->m_rx_buf );
+}
+
+// Echo SOCK_PROFILE_BENCH_BYTES, sending and receiving at once, time in ms
+static BaseType_t socket_bench_tput( Socket_t t_sock, uint8_t *t_buf )
+{
+	uint32_t l_tx = 0, l_rx = 0;
+	TickType_t l_start = xTaskGetTickCount();
+
+	memset( t_buf, 'x', SOCK_BENCH_CHUNK );
+
+	while ( l_rx < SOCK_PROFILE_BENCH_BYTES )
+	{
+		BaseType_t l_len = 0;
+		if ( l_tx < SOCK_PROFILE_BENCH_BYTES )
+		{
+			uint32_t l_chunk = SOCK_PROFILE_BENCH_BYTES - l_tx;
+			if ( l_chunk > SOCK_BENCH_CHUNK ) l_chunk = SOCK_BENCH_CHUNK;
+
+			l_len = FreeRTOS_send( t_sock, t_buf, l_chunk, FREERTOS_MSG_DONTWAIT );
+			if ( l_len < 0 && l_len != -pdFREERTOS_ERRNO_ENOSPC ) return -1;
+			if ( l_len > 0 ) l_tx += l_len;
+		}
+
+		// wait for echo only when nothing could be sent
+		BaseType_t l_echo = FreeRTOS_recv( t_sock, t_buf + SOCK_BENCH_CHUNK, SOCK_BENCH_CHUNK,
+				l_len > 0 ? FREERTOS_MSG_DONTWAIT : 0 );
+		if ( l_echo < 0 ) return -1;
+		if ( l_echo == 0 && l_len <= 0 ) return -1;		// timeout
+		l_rx += l_echo;
+	}
+
+	return ( xTaskGetTickCount() - l_start ) * portTICK_PERIOD_MS;
+}
+
+// Ping-pong of one byte, round trip times in us
+static bool socket_bench_rtt( Socket_t t_sock, uint32_t *t_min, uint32_t *t_avg, uint32_t *t_max )
+{
+	uint32_t l_cycles_us = SystemCoreClock / 1000000;
+	uint32_t l_sum = 0;
+	uint8_t l_byte = 'p';
+
+	*t_min = UINT32_MAX;
+	*t_max = 0;
+
+	for ( uint32_t i = 0; i < SOCK_PROFILE_BENCH_PINGS; i++ )
+	{
+		uint32_t l_start = portGET_RUN_TIME_COUNTER_VALUE();
+
+		if ( FreeRTOS_send( t_sock, &l_byte, 1, 0 ) != 1 ) return false;
+		if ( FreeRTOS_recv( t_sock, &l_byte, 1, 0 ) != 1 ) return false;
+
+		uint32_t l_us = ( portGET_RUN_TIME_COUNTER_VALUE() - l_start ) / l_cycles_us;
+		l_sum += l_us;
+		if ( l_us < *t_min ) *t_min = l_us;
+		if ( l_us > *t_max ) *t_max = l_us;
+	}
+
+	*t_avg = l_sum / SOCK_PROFILE_BENCH_PINGS;
+	return true;
+}
+
+void task_socket_bench( void *t_arg )
+{
+	uint8_t l_buf[ 2 * SOCK_BENCH_CHUNK ];
+	TickType_t l_tout = pdMS_TO_TICKS( SOCK_BENCH_TOUT_MS );
+
+	for ( uint32_t p = 0; p < SOCK_PROFILE_COUNT; p++ )
+	{
+		SocketProfileId l_id = ( SocketProfileId ) p;
+		const char *l_name = SocketProfileGet( l_id )->m_name;
+
+		Socket_t l_sock = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+		if ( l_sock == FREERTOS_INVALID_SOCKET )
+		{
+			PRINTF( "SP %s no socket\r\n", l_name );
+			continue;
+		}
+
+		socket_option( l_sock, FREERTOS_SO_RCVTIMEO, l_tout );
+		socket_option( l_sock, FREERTOS_SO_SNDTIMEO, l_tout );
+		SocketProfileApply( l_sock, l_id );
+
+		if ( FreeRTOS_connect( l_sock, &g_sock_bench_addr, sizeof( g_sock_bench_addr ) ) != 0 )
+		{
+			PRINTF( "SP %s unable to connect to echo server\r\n", l_name );
+			FreeRTOS_closesocket( l_sock );
+			continue;
+		}
+
+		BaseType_t l_ms = socket_bench_tput( l_sock, l_buf );
+		uint32_t l_min, l_avg, l_max;
+		bool l_rtt = l_ms >= 0 && socket_bench_rtt( l_sock, &l_min, &l_avg, &l_max );
+
+		if ( l_rtt )
+			PRINTF( "SP %s ram %u tput %u KB/s rtt %u %u %u us\r\n", l_name, SocketProfileRam( l_id ),
+					SOCK_PROFILE_BENCH_BYTES / ( l_ms ? l_ms : 1 ), l_min, l_avg, l_max );
+		else
+			PRINTF( "SP %s ram %u failed\r\n", l_name, SocketProfileRam( l_id ) );
+
+		FreeRTOS_shutdown( l_sock, FREERTOS_SHUT_RDWR );
+		FreeRTOS_closesocket( l_sock );
+	}
+
+	vTaskDelete( NULL );
+}
+
+// Create task measuring all profiles against echo server t_addr
+void SocketProfileBenchInit( const struct freertos_sockaddr *t_addr, UBaseType_t t_priority )
+{
+	g_sock_bench_addr = *t_addr;
+
+	if ( APP_TASK_CREATE( task_socket_bench, TASK_NAME_SOCKET_BENCH, configMINIMAL_STACK_SIZE + 400,
+			NULL, t_priority, NULL ) != pdPASS )
+	{
+		PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_SOCKET_BENCH );
+	}
+}
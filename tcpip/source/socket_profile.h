@@ -0,0 +1,84 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Named buffer and window profiles of TCP sockets
+//
+// **************************************************************************
+//
+// Profile sets stream buffers and windows of socket by
+// FREERTOS_SO_WIN_PROPERTIES. It must be applied before buffers are
+// created, so before FreeRTOS_connect() or to listening socket before
+// FreeRTOS_listen(), accepted sockets inherit it.
+//
+// SOCK_PROFILE_LOW_LATENCY   one segment windows, short queues
+// SOCK_PROFILE_BULK          more segments in flight for telemetry
+// SOCK_PROFILE_MIN_RAM       the smallest buffers, former server setting
+//
+// FreeRTOS+TCP rounds Tx buffer up to MSS, so Tx buffer is never smaller
+// than one segment. SocketProfileRam() returns heap allocated for both
+// streams of one socket after this rounding.
+//
+// Board test connects for every profile to echo server on host, e.g.
+//
+//   socat TCP-LISTEN:3334,fork,reuseaddr EXEC:cat
+//
+// and prints one line per profile:
+//
+// SP <profile> ram <bytes> tput <KB/s> rtt <min> <avg> <max> us
+//
+// Throughput is echoed data, so it is limited by the smaller direction.
+
+#ifndef SOCKET_PROFILE_H
+#define SOCKET_PROFILE_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+
+#define SOCK_PROFILE_BENCH_BYTES	( 64 * 1024 )
+#define SOCK_PROFILE_BENCH_PINGS	100
+
+enum SocketProfileId
+{
+	SOCK_PROFILE_LOW_LATENCY,
+	SOCK_PROFILE_BULK,
+	SOCK_PROFILE_MIN_RAM,
+	SOCK_PROFILE_COUNT
+};
+
+struct SocketProfile
+{
+	const char *m_name;
+	int32_t m_tx_buf;						// bytes
+	int32_t m_tx_win;						// segments
+	int32_t m_rx_buf;
+	int32_t m_rx_win;
+};
+
+// Set one socket option, value is passed by pointer as setsockopt wants
+template< typename T >
+inline BaseType_t socket_option( Socket_t t_socket, int32_t t_option, const T &t_value )
+{
+	return FreeRTOS_setsockopt( t_socket, 0, t_option, ( const void * ) &t_value, sizeof( t_value ) );
+}
+
+// Parameters of profile
+const SocketProfile *SocketProfileGet( SocketProfileId t_id );
+
+// Apply profile to socket, 0 or negative error of FreeRTOS_setsockopt()
+BaseType_t SocketProfileApply( Socket_t t_socket, SocketProfileId t_id );
+
+// Heap used by stream buffers of one socket with profile
+size_t SocketProfileRam( SocketProfileId t_id );
+
+// Create task measuring all profiles against echo server t_addr
+void SocketProfileBenchInit( const struct freertos_sockaddr *t_addr, UBaseType_t t_priority );
+
+#endif // SOCKET_PROFILE_H
@@ -0,0 +1,55 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Tasks and kernel objects with static or dynamic memory
+//
+// **************************************************************************
+//
+// FreeRTOS kernel includes.
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "static_alloc.h"
+
+#if configSUPPORT_STATIC_ALLOCATION
+
+extern "C" {
+void vApplicationGetIdleTaskMemory( StaticTask_t **t_tcb, StackType_t **t_stack, uint32_t *t_stack_size );
+}
+
+// Kernel requires memory for idle task when static allocation is supported
+void vApplicationGetIdleTaskMemory( StaticTask_t **t_tcb, StackType_t **t_stack, uint32_t *t_stack_size )
+{
+	static StaticTask_t s_alloc_idle_tcb;
+	static StackType_t s_alloc_idle_stack[ configMINIMAL_STACK_SIZE ];
+
+	*t_tcb = &s_alloc_idle_tcb;
+	*t_stack = s_alloc_idle_stack;
+	*t_stack_size = configMINIMAL_STACK_SIZE;
+}
+
+#if configUSE_TIMERS
+
+extern "C" {
+void vApplicationGetTimerTaskMemory( StaticTask_t **t_tcb, StackType_t **t_stack, uint32_t *t_stack_size );
+}
+
+// Memory for timer service task
+void vApplicationGetTimerTaskMemory( StaticTask_t **t_tcb, StackType_t **t_stack, uint32_t *t_stack_size )
+{
+	static StaticTask_t s_alloc_timer_tcb;
+	static StackType_t s_alloc_timer_stack[ configTIMER_TASK_STACK_DEPTH ];
+
+	*t_tcb = &s_alloc_timer_tcb;
+	*t_stack = s_alloc_timer_stack;
+	*t_stack_size = configTIMER_TASK_STACK_DEPTH;
+}
+
+#endif // configUSE_TIMERS
+
+#endif // configSUPPORT_STATIC_ALLOCATION
@@ -0,0 +1,43 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Stack and heap usage of all tasks
+//
+// **************************************************************************
+//
+// Monitor task periodically prints one line for heap and one line for
+// every task to debug console:
+//
+// TM idle <idle time of last period in 0.1 %>
+// TM heap <free> <minimum ever free> <total>
+// TM task <name> <state> <priority> <stack depth> <stack high water mark>
+// TM end <number of tasks>
+//
+// Sizes of heap are in bytes, stack depth and high water mark in words.
+// Stack depth is known only for tasks created by APP_TASK_CREATE(),
+// it is 0 for other tasks. State is X running, R ready, B blocked,
+// S suspended, D deleted. Idle line is printed only with
+// configGENERATE_RUN_TIME_STATS, run time counter is DWT cycle counter,
+// so period must be shorter than its overflow (35 s at 120 MHz).
+//
+// tools/stack_report.py reads saved console output and recommends
+// stack sizes from the lowest high water mark of every task.
+
+#ifndef TASK_MONITOR_H
+#define TASK_MONITOR_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define TASK_MONITOR_PERIOD_MS		10000
+#define TASK_MONITOR_MAX_TASKS		16
+
+// Create monitor task, the lowest priority above idle is recommended
+void TaskMonitorInit( uint32_t t_period_ms, UBaseType_t t_priority );
+
+#endif // TASK_MONITOR_H
@@ -0,0 +1,374 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         TCP server for more clients in one task
+//
+// **************************************************************************
+//
+// FreeRTOS kernel includes.
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+// System includes.
+#include <cstring>
+#include "fsl_debug_console.h"
+#include "tcp_server.h"
+#include "static_alloc.h"
+
+#define TASK_NAME_TCP_SERVER	"tcp_server"
+
+struct TcpServerMsg
+{
+	uint8_t m_len;
+	uint8_t m_data[ TCP_SERVER_MSG_SIZE ];
+};
+
+static TcpConnection g_tcp_conn[ TCP_SERVER_CLIENTS ];
+static TcpServerHandler g_tcp_handler;
+static TcpServerHandler g_tcp_bcast_handler = NULL;
+static uint16_t g_tcp_port;
+static QueueHandle_t g_tcp_msg_queue;
+static Socket_t volatile g_tcp_listen = NULL;
+static uint32_t g_tcp_conn_count = 0;
+static volatile SocketProfileId g_tcp_profile = TCP_SERVER_PROFILE;
+
+// Close connection and free its slot
+static void tcp_server_close( SocketSet_t t_set, TcpConnection *t_conn )
+{
+	PRINTF( "TCP client %u closed, rx %u tx %u bytes, dropped %u coalesced %u messages.\r\n",
+			t_conn->m_id, t_conn->m_rx_bytes, t_conn->m_tx_bytes, t_conn->m_tx_dropped, t_conn->m_tx_coalesced );
+
+	FreeRTOS_FD_CLR( t_conn->m_socket, t_set, eSELECT_ALL );
+	FreeRTOS_closesocket( t_conn->m_socket );
+	t_conn->m_socket = NULL;
+}
+
+// Accept all waiting clients, client without free slot is closed
+static void tcp_server_accept( SocketSet_t t_set, Socket_t t_listen )
+{
+	TickType_t l_rx_tout = 0;
+
+	while ( 1 )
+	{
+		struct freertos_sockaddr l_addr;
+		socklen_t l_addr_size = sizeof( l_addr );
+
+		Socket_t l_sock = FreeRTOS_accept( t_listen, &l_addr, &l_addr_size );
+		if ( l_sock == NULL || l_sock == FREERTOS_INVALID_SOCKET ) return;
+
+		TcpConnection *l_conn = NULL;
+		for ( uint32_t i = 0; i < TCP_SERVER_CLIENTS; i++ )
+		{
+			if ( g_tcp_conn[ i ].m_socket == NULL )
+			{
+				l_conn = &g_tcp_conn[ i ];
+				break;
+			}
+		}
+
+		if ( !l_conn )
+		{
+			PRINTF( "TCP server full, client refused.\r\n" );
+			FreeRTOS_closesocket( l_sock );
+			continue;
+		}
+
+		FreeRTOS_setsockopt( l_sock, 0, FREERTOS_SO_RCVTIMEO, &l_rx_tout, sizeof( l_rx_tout ) );
+
+		l_conn->m_socket = l_sock;
+		l_conn->m_slot = l_conn - g_tcp_conn;
+		l_conn->m_addr = l_addr;
+		l_conn->m_id = ++g_tcp_conn_count;
+		l_conn->m_rx_bytes = l_conn->m_tx_bytes = 0;
+		l_conn->m_tx_policy = TCP_SERVER_TX_POLICY;
+		l_conn->m_tx_head = l_conn->m_tx_count = l_conn->m_tx_sent = 0;
+		l_conn->m_tx_close = false;
+		l_conn->m_tx_dropped = l_conn->m_tx_coalesced = 0;
+
+		FreeRTOS_FD_SET( l_sock, t_set, eSELECT_READ | eSELECT_EXCEPT );
+
+		PRINTF( "TCP client %u connected from %u.%u.%u.%u:%u.\r\n", l_conn->m_id,
+				( unsigned ) ( l_addr.sin_addr & 0xFF ), ( unsigned ) ( ( l_addr.sin_addr >> 8 ) & 0xFF ),
+				( unsigned ) ( ( l_addr.sin_addr >> 16 ) & 0xFF ), ( unsigned ) ( l_addr.sin_addr >> 24 ),
+				FreeRTOS_ntohs( l_addr.sin_port ) );
+	}
+}
+
+// Send all queued broadcast messages to all clients
+static void tcp_server_broadcast( SocketSet_t t_set )
+{
+	TcpServerMsg l_msg;
+
+	while ( xQueueReceive( g_tcp_msg_queue, &l_msg, 0 ) == pdPASS )
+	{
+		for ( uint32_t i = 0; i < TCP_SERVER_CLIENTS; i++ )
+		{
+			if ( !g_tcp_conn[ i ].m_socket ) continue;
+
+			if ( g_tcp_bcast_handler )
+				g_tcp_bcast_handler( &g_tcp_conn[ i ], l_msg.m_data, l_msg.m_len );
+			else
+				TcpServerSend( &g_tcp_conn[ i ], l_msg.m_data, l_msg.m_len );
+		}
+	}
+}
+
+// Send ring of connection without waiting, select waits for free space
+static void tcp_server_flush( SocketSet_t t_set, TcpConnection *t_conn )
+{
+	while ( t_conn->m_tx_count )
+	{
+		TcpTxSlot *l_slot = &t_conn->m_tx[ t_conn->m_tx_head ];
+		BaseType_t l_len = FreeRTOS_send( t_conn->m_socket, l_slot->m_data + t_conn->m_tx_sent,
+				l_slot->m_len - t_conn->m_tx_sent, FREERTOS_MSG_DONTWAIT );
+
+		if ( l_len < 0 && l_len != -pdFREERTOS_ERRNO_ENOSPC )
+		{
+			tcp_server_close( t_set, t_conn );
+			return;
+		}
+		if ( l_len <= 0 ) break;
+
+		t_conn->m_tx_bytes += l_len;
+		t_conn->m_tx_sent += l_len;
+		if ( t_conn->m_tx_sent < l_slot->m_len ) break;
+
+		t_conn->m_tx_head = ( t_conn->m_tx_head + 1 ) % TCP_SERVER_TX_SLOTS;
+		t_conn->m_tx_count--;
+		t_conn->m_tx_sent = 0;
+	}
+
+	if ( t_conn->m_tx_count )
+		FreeRTOS_FD_SET( t_conn->m_socket, t_set, eSELECT_WRITE );
+	else
+		FreeRTOS_FD_CLR( t_conn->m_socket, t_set, eSELECT_WRITE );
+}
+
+// Store one slot, false if it was dropped
+static bool tcp_server_push( TcpConnection *t_conn, const uint8_t *t_data, size_t t_len, uint8_t t_kind )
+{
+	// first slot may be partially sent, it can not be changed
+	uint32_t l_first = t_conn->m_tx_sent ? 1 : 0;
+
+	if ( t_conn->m_tx_policy == TCP_TX_COALESCE && t_kind )
+	{
+		for ( uint32_t i = t_conn->m_tx_count; i-- > l_first; )
+		{
+			TcpTxSlot *l_slot = &t_conn->m_tx[ ( t_conn->m_tx_head + i ) % TCP_SERVER_TX_SLOTS ];
+			if ( l_slot->m_kind == t_kind )
+			{
+				memcpy( l_slot->m_data, t_data, t_len );
+				l_slot->m_len = t_len;
+				t_conn->m_tx_coalesced++;
+				return true;
+			}
+		}
+	}
+
+	if ( t_conn->m_tx_count == TCP_SERVER_TX_SLOTS )
+	{
+		if ( t_conn->m_tx_policy == TCP_TX_DISCONNECT )
+		{
+			t_conn->m_tx_close = true;
+			return false;
+		}
+
+		t_conn->m_tx_dropped++;
+		if ( t_conn->m_tx_policy == TCP_TX_COALESCE ) return false;
+
+		// drop the oldest not started message, following ones move forward
+		for ( uint32_t i = l_first; i + 1 < t_conn->m_tx_count; i++ )
+			t_conn->m_tx[ ( t_conn->m_tx_head + i ) % TCP_SERVER_TX_SLOTS ] =
+					t_conn->m_tx[ ( t_conn->m_tx_head + i + 1 ) % TCP_SERVER_TX_SLOTS ];
+		t_conn->m_tx_count--;
+	}
+
+	TcpTxSlot *l_slot = &t_conn->m_tx[ ( t_conn->m_tx_head + t_conn->m_tx_count ) % TCP_SERVER_TX_SLOTS ];
+	l_slot->m_kind = t_kind;
+	l_slot->m_len = t_len;
+	memcpy( l_slot->m_data, t_data, t_len );
+	t_conn->m_tx_count++;
+	return true;
+}
+
+void task_tcp_server( void *t_arg )
+{
+	struct freertos_sockaddr l_srv_address;
+	SocketProfileId l_profile = g_tcp_profile;
+	TickType_t l_accept_tout = 0;
+	uint8_t l_rx_buf[ TCP_SERVER_RX_SIZE ];
+	uint32_t l_first = 0;
+
+	l_srv_address.sin_port = FreeRTOS_htons( g_tcp_port );
+	l_srv_address.sin_addr = FreeRTOS_inet_addr_quick( 0, 0, 0, 0 );
+
+	Socket_t l_listen = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+	configASSERT( l_listen != FREERTOS_INVALID_SOCKET );
+
+	BaseType_t l_bind_result = FreeRTOS_bind( l_listen, &l_srv_address, sizeof l_srv_address );
+	configASSERT( l_bind_result == 0 );
+
+	// accept must not block, select waits for clients
+	FreeRTOS_setsockopt( l_listen, 0, FREERTOS_SO_RCVTIMEO, &l_accept_tout, sizeof( l_accept_tout ) );
+
+	// accepted sockets inherit buffers of listening socket
+	SocketProfileApply( l_listen, l_profile );
+
+	FreeRTOS_listen( l_listen, TCP_SERVER_CLIENTS );
+
+	SocketSet_t l_set = FreeRTOS_CreateSocketSet();
+	configASSERT( l_set != NULL );
+	FreeRTOS_FD_SET( l_listen, l_set, eSELECT_READ );
+
+	g_tcp_listen = l_listen;
+
+	PRINTF( "TCP server listening on port %u for %d clients, profile %s, %u bytes per client.\r\n", g_tcp_port,
+			TCP_SERVER_CLIENTS, SocketProfileGet( l_profile )->m_name, SocketProfileRam( l_profile ) );
+
+	while ( 1 )
+	{
+		// woken by data, new client, closed client or FreeRTOS_SignalSocket()
+		FreeRTOS_select( l_set, portMAX_DELAY );
+
+		if ( l_profile != g_tcp_profile )
+		{
+			l_profile = g_tcp_profile;
+			SocketProfileApply( l_listen, l_profile );
+			PRINTF( "TCP server profile %s, %u bytes per client.\r\n",
+					SocketProfileGet( l_profile )->m_name, SocketProfileRam( l_profile ) );
+		}
+
+		if ( FreeRTOS_FD_ISSET( l_listen, l_set ) & eSELECT_READ )
+			tcp_server_accept( l_set, l_listen );
+
+		// one block from every client, first client rotates
+		for ( uint32_t n = 0; n < TCP_SERVER_CLIENTS; n++ )
+		{
+			TcpConnection *l_conn = &g_tcp_conn[ ( l_first + n ) % TCP_SERVER_CLIENTS ];
+			if ( !l_conn->m_socket ) continue;
+
+			EventBits_t l_bits = FreeRTOS_FD_ISSET( l_conn->m_socket, l_set );
+			if ( !( l_bits & ( eSELECT_READ | eSELECT_EXCEPT ) ) ) continue;
+
+			BaseType_t l_len = FreeRTOS_recv( l_conn->m_socket, l_rx_buf, sizeof( l_rx_buf ), 0 );
+
+			if ( l_len > 0 )
+			{
+				l_conn->m_rx_bytes += l_len;
+				g_tcp_handler( l_conn, l_rx_buf, l_len );
+			}
+			else if ( l_len < 0 || ( l_bits & eSELECT_EXCEPT ) )
+			{
+				tcp_server_close( l_set, l_conn );
+			}
+		}
+		l_first = ( l_first + 1 ) % TCP_SERVER_CLIENTS;
+
+		tcp_server_broadcast( l_set );
+
+		for ( uint32_t i = 0; i < TCP_SERVER_CLIENTS; i++ )
+		{
+			TcpConnection *l_conn = &g_tcp_conn[ i ];
+			if ( !l_conn->m_socket ) continue;
+
+			if ( l_conn->m_tx_close )
+			{
+				PRINTF( "TCP client %u is too slow.\r\n", l_conn->m_id );
+				tcp_server_close( l_set, l_conn );
+			}
+			else if ( l_conn->m_tx_count )
+				tcp_server_flush( l_set, l_conn );
+		}
+	}
+}
+
+// Create server task listening on t_port
+void TcpServerInit( uint16_t t_port, TcpServerHandler t_handler, UBaseType_t t_priority )
+{
+	g_tcp_port = t_port;
+	g_tcp_handler = t_handler;
+	g_tcp_msg_queue = APP_QUEUE_CREATE( tcp_server, TCP_SERVER_MSG_QUEUE_LEN, sizeof( TcpServerMsg ) );
+
+	if ( APP_TASK_CREATE( task_tcp_server, TASK_NAME_TCP_SERVER, configMINIMAL_STACK_SIZE + 1024,
+			NULL, t_priority, NULL ) != pdPASS )
+	{
+		PRINTF( "Unable to create task '%s'!\r\n", TASK_NAME_TCP_SERVER );
+	}
+}
+
+// Store message into ring of client, it is sent by server task later
+bool TcpServerSend( TcpConnection *t_conn, const void *t_data, size_t t_len, uint8_t t_kind )
+{
+	const uint8_t *l_data = ( const uint8_t * ) t_data;
+	bool l_ok = true;
+
+	// long message can not be coalesced
+	if ( t_len > TCP_SERVER_TX_MSG_SIZE ) t_kind = 0;
+
+	while ( t_len && !t_conn->m_tx_close )
+	{
+		size_t l_len = t_len < TCP_SERVER_TX_MSG_SIZE ? t_len : TCP_SERVER_TX_MSG_SIZE;
+		l_ok &= tcp_server_push( t_conn, l_data, l_len, t_kind );
+		l_data += l_len;
+		t_len -= l_len;
+	}
+	return l_ok && !t_conn->m_tx_close;
+}
+
+// Overflow policy of connection
+void TcpServerSetTxPolicy( TcpConnection *t_conn, TcpTxPolicy t_policy )
+{
+	t_conn->m_tx_policy = t_policy;
+}
+
+// Queue message for all clients
+bool TcpServerBroadcast( const void *t_data, size_t t_len )
+{
+	Socket_t l_listen = g_tcp_listen;
+	TcpServerMsg l_msg;
+
+	if ( !l_listen || t_len > TCP_SERVER_MSG_SIZE ) return false;
+
+	l_msg.m_len = t_len;
+	memcpy( l_msg.m_data, t_data, t_len );
+
+	if ( xQueueSend( g_tcp_msg_queue, &l_msg, 0 ) != pdPASS ) return false;
+
+	// wake up server task in FreeRTOS_select()
+	FreeRTOS_SignalSocket( l_listen );
+	return true;
+}
+
+// Handler of broadcast messages
+void TcpServerSetBroadcastHandler( TcpServerHandler t_handler )
+{
+	g_tcp_bcast_handler = t_handler;
+}
+
+// Socket profile of clients connected later
+void TcpServerSetProfile( SocketProfileId t_profile )
+{
+	Socket_t l_listen = g_tcp_listen;
+
+	g_tcp_profile = t_profile;
+
+	// server task applies it to listening socket
+	if ( l_listen ) FreeRTOS_SignalSocket( l_listen );
+}
+
+// Number of connected clients
+uint32_t TcpServerClients()
+{
+	uint32_t l_count = 0;
+	for ( uint32_t i = 0; i < TCP_SERVER_CLIENTS; i++ )
+	{
+		if ( g_tcp_conn[ i ].m_socket ) l_count++;
+	}
+	return l_count;
+}
@@ -0,0 +1,124 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         TCP server for more clients in one task
+//
+// **************************************************************************
+//
+// One task waits in FreeRTOS_select() for listening socket and all client
+// sockets. New client is accepted immediately into free slot. In every
+// round only one block of data is read from every ready client, starting
+// with next client than in previous round, so one busy client can not
+// stall others.
+//
+// Received data is passed to handler in server task. Handler replies by
+// TcpServerSend(). Other tasks send data to all clients by
+// TcpServerBroadcast(), message is queued and server task is woken up
+// by FreeRTOS_SignalSocket().
+//
+// Server task never waits for client. TcpServerSend() only stores message
+// into ring of connection and server task sends rings with
+// FREERTOS_MSG_DONTWAIT, socket of client with data in ring is selected
+// for eSELECT_WRITE, too. When ring is full, policy of connection decides:
+//
+// TCP_TX_DROP_OLDEST      the oldest not started message is dropped
+// TCP_TX_COALESCE         message of the same kind waiting in ring is
+//                         replaced by new one, otherwise new one is dropped
+// TCP_TX_DISCONNECT       connection is closed
+//
+// With TCP_TX_COALESCE message with kind other than 0 replaces waiting
+// message of the same kind even if ring is not full, only the latest
+// state is sent to slow client.
+//
+// Buffers and windows of clients are given by socket profile, see
+// socket_profile.h. Profile is set to listening socket and new clients
+// inherit it, so TcpServerSetProfile() changes only later connections.
+
+#ifndef TCP_SERVER_H
+#define TCP_SERVER_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+#include "socket_profile.h"
+
+#define TCP_SERVER_CLIENTS			4
+#define TCP_SERVER_RX_SIZE			256
+#define TCP_SERVER_MSG_SIZE			32
+#define TCP_SERVER_MSG_QUEUE_LEN	8
+
+// Buffers of client sockets
+#define TCP_SERVER_PROFILE			SOCK_PROFILE_MIN_RAM
+
+// Ring of every connection, longer message is split into more slots
+#define TCP_SERVER_TX_SLOTS			8
+#define TCP_SERVER_TX_MSG_SIZE		128
+#define TCP_SERVER_TX_POLICY		TCP_TX_DROP_OLDEST
+
+enum TcpTxPolicy
+{
+	TCP_TX_DROP_OLDEST,
+	TCP_TX_COALESCE,
+	TCP_TX_DISCONNECT
+};
+
+struct TcpTxSlot
+{
+	uint8_t m_kind;							// 0 is never coalesced
+	uint8_t m_len;
+	uint8_t m_data[ TCP_SERVER_TX_MSG_SIZE ];
+};
+
+struct TcpConnection
+{
+	Socket_t m_socket;						// NULL if slot is free
+	uint32_t m_slot;						// index 0..TCP_SERVER_CLIENTS-1
+	struct freertos_sockaddr m_addr;
+	uint32_t m_id;							// number of connection since start
+	uint32_t m_rx_bytes;
+	uint32_t m_tx_bytes;
+
+	// transmit ring
+	TcpTxPolicy m_tx_policy;
+	TcpTxSlot m_tx[ TCP_SERVER_TX_SLOTS ];
+	uint32_t m_tx_head;						// the oldest message
+	uint32_t m_tx_count;
+	uint32_t m_tx_sent;						// bytes of head already sent
+	bool m_tx_close;						// ring overflow with TCP_TX_DISCONNECT
+	uint32_t m_tx_dropped;					// messages
+	uint32_t m_tx_coalesced;				// messages
+};
+
+// Called by server task for every block of received data
+typedef void ( *TcpServerHandler )( TcpConnection *t_conn, const uint8_t *t_data, size_t t_len );
+
+// Create server task listening on t_port
+void TcpServerInit( uint16_t t_port, TcpServerHandler t_handler, UBaseType_t t_priority );
+
+// Store message into ring of client, only from server task (handler).
+// Returns false if message or its part was dropped.
+bool TcpServerSend( TcpConnection *t_conn, const void *t_data, size_t t_len, uint8_t t_kind = 0 );
+
+// Overflow policy of connection, default is TCP_SERVER_TX_POLICY
+void TcpServerSetTxPolicy( TcpConnection *t_conn, TcpTxPolicy t_policy );
+
+// Queue message for all clients, may be called by any task
+bool TcpServerBroadcast( const void *t_data, size_t t_len );
+
+// Broadcast message is passed to t_handler for every client instead of
+// sending it as is, handler formats it for protocol of client
+void TcpServerSetBroadcastHandler( TcpServerHandler t_handler );
+
+// Socket profile of clients connected later, may be called by any task
+void TcpServerSetProfile( SocketProfileId t_profile );
+
+// Number of connected clients
+uint32_t TcpServerClients();
+
+#endif // TCP_SERVER_H
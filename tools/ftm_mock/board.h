@@ -0,0 +1,39 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Host mock of board and device for rgb_pwm test
+//
+// **************************************************************************
+//
+// Only parts used by tasks/source/rgb_pwm.cpp. Registers are plain
+// variables, tools/rgb_pwm_test.cpp simulates FTM0 counter on them.
+
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <stdint.h>
+#include "fsl_gpio.h"
+#include "fsl_ftm.h"
+
+typedef enum { FTM0_IRQn = 42 } IRQn_Type;
+
+typedef enum { kCLOCK_BusClk } clock_name_t;
+
+#define MOCK_BUS_CLOCK_HZ		60000000U
+
+static inline uint32_t CLOCK_GetFreq( clock_name_t ) { return MOCK_BUS_CLOCK_HZ; }
+
+// Interrupt of FTM0 is delivered by simulation only when enabled
+extern bool g_mock_irq_enabled;
+extern uint32_t g_mock_irq_priority;
+
+static inline void NVIC_SetPriority( IRQn_Type, uint32_t t_prio ) { g_mock_irq_priority = t_prio; }
+static inline void EnableIRQ( IRQn_Type ) { g_mock_irq_enabled = true; }
+static inline void DisableIRQ( IRQn_Type ) { g_mock_irq_enabled = false; }
+
+#endif // BOARD_H
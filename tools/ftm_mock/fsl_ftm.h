@@ -0,0 +1,118 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Host mock of FTM driver for rgb_pwm test
+//
+// **************************************************************************
+//
+// Register fields used by rgb_pwm.cpp and FTM state hidden in hardware:
+// channel values loaded into comparators, status flags, pending software
+// trigger. Driver functions do the same register work as drivers/fsl_ftm.c
+// for edge aligned PWM. Writes to CnV are buffered until the end of period
+// after software trigger, as with reloadPoints = kFTM_CntMax.
+
+#ifndef FSL_FTM_H
+#define FSL_FTM_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define FTM_CHANNELS			8
+
+typedef struct
+{
+	volatile uint32_t SC;					// PS prescaler in bits 0..2
+	volatile uint32_t CNT;
+	volatile uint32_t MOD;
+	struct
+	{
+		volatile uint32_t CnSC;
+		volatile uint32_t CnV;
+	} CONTROLS[ FTM_CHANNELS ];
+
+	// hardware state, not registers
+	uint32_t m_loaded_cnv[ FTM_CHANNELS ];
+	uint32_t m_flags;
+	uint32_t m_irq_mask;
+	bool m_sw_trigger;
+	bool m_running;
+} FTM_Type;
+
+extern FTM_Type g_mock_ftm0;
+#define FTM0					( &g_mock_ftm0 )
+
+typedef enum { kFTM_Prescale_Divide_1, kFTM_Prescale_Divide_128 = 7 } ftm_clock_prescale_t;
+typedef enum { kFTM_Chnl_0, kFTM_Chnl_1, kFTM_Chnl_2 } ftm_chnl_t;
+typedef enum { kFTM_LowTrue, kFTM_HighTrue } ftm_pwm_level_select_t;
+typedef enum { kFTM_EdgeAlignedPwm, kFTM_CenterAlignedPwm } ftm_pwm_mode_t;
+typedef enum { kFTM_SystemClock = 1 } ftm_clock_source_t;
+typedef enum { kFTM_CntMax = ( 1U << 3 ) } ftm_reload_point_t;
+
+enum { kFTM_TimeOverflowFlag = ( 1U << 9 ) };
+enum { kFTM_TimeOverflowInterruptEnable = ( 1U << 9 ) };
+
+typedef struct
+{
+	ftm_clock_prescale_t prescale;
+	uint32_t reloadPoints;
+} ftm_config_t;
+
+typedef struct
+{
+	ftm_chnl_t chnlNumber;
+	ftm_pwm_level_select_t level;
+	uint8_t dutyCyclePercent;
+	uint8_t firstEdgeDelayPercent;
+	bool enableComplementary;
+	bool enableDeadtime;
+} ftm_chnl_pwm_signal_param_t;
+
+static inline void FTM_GetDefaultConfig( ftm_config_t *t_config )
+{
+	memset( t_config, 0, sizeof( *t_config ) );
+}
+
+static inline ftm_clock_prescale_t FTM_CalculateCounterClkDiv( FTM_Type *, uint32_t t_period_hz, uint32_t t_src_hz )
+{
+	uint32_t i;
+	for ( i = 0; i < kFTM_Prescale_Divide_128; i++ )
+		if ( t_src_hz / ( 1UL << i ) / 0xFFFFU < t_period_hz )
+			break;
+	return ( ftm_clock_prescale_t ) i;
+}
+
+static inline int FTM_Init( FTM_Type *t_base, const ftm_config_t *t_config )
+{
+	memset( t_base, 0, sizeof( *t_base ) );
+	t_base->SC = t_config->prescale;
+	return 0;
+}
+
+static inline int FTM_SetupPwm( FTM_Type *t_base, const ftm_chnl_pwm_signal_param_t *t_params, uint8_t t_num,
+		ftm_pwm_mode_t, uint32_t t_freq_hz, uint32_t t_src_hz )
+{
+	uint32_t l_mod = ( t_src_hz / ( 1U << ( t_base->SC & 7 ) ) / t_freq_hz ) - 1U;
+	if ( l_mod > 65535U ) return 1;
+	t_base->MOD = l_mod;
+
+	for ( uint8_t i = 0; i < t_num; i++ )
+	{
+		uint32_t l_cnv = t_params[ i ].dutyCyclePercent == 100 ? l_mod + 1U : l_mod * t_params[ i ].dutyCyclePercent / 100U;
+		t_base->CONTROLS[ t_params[ i ].chnlNumber ].CnV = l_cnv;
+		t_base->m_loaded_cnv[ t_params[ i ].chnlNumber ] = l_cnv;
+	}
+	return 0;
+}
+
+static inline void FTM_EnableInterrupts( FTM_Type *t_base, uint32_t t_mask ) { t_base->m_irq_mask |= t_mask; }
+static inline uint32_t FTM_GetStatusFlags( FTM_Type *t_base ) { return t_base->m_flags; }
+static inline void FTM_ClearStatusFlags( FTM_Type *t_base, uint32_t t_mask ) { t_base->m_flags &= ~t_mask; }
+static inline void FTM_SetSoftwareTrigger( FTM_Type *t_base, bool t_enable ) { t_base->m_sw_trigger = t_enable; }
+static inline void FTM_StartTimer( FTM_Type *t_base, ftm_clock_source_t ) { t_base->m_running = true; }
+
+#endif // FSL_FTM_H
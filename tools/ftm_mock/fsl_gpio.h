@@ -0,0 +1,29 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Host mock of GPIO driver for rgb_pwm test
+//
+// **************************************************************************
+
+#ifndef FSL_GPIO_H
+#define FSL_GPIO_H
+
+#include <stdint.h>
+
+typedef struct
+{
+	volatile uint32_t PDOR;					// output data
+} GPIO_Type;
+
+extern GPIO_Type g_mock_gpiob;
+#define GPIOB					( &g_mock_gpiob )
+
+static inline void GPIO_PortSet( GPIO_Type *t_base, uint32_t t_mask ) { t_base->PDOR |= t_mask; }
+static inline void GPIO_PortClear( GPIO_Type *t_base, uint32_t t_mask ) { t_base->PDOR &= ~t_mask; }
+
+#endif // FSL_GPIO_H
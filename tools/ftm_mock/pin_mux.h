@@ -0,0 +1,26 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Host mock of pin_mux.h for rgb_pwm test
+//
+// **************************************************************************
+
+#ifndef PIN_MUX_H
+#define PIN_MUX_H
+
+#define LED_PTB2_GPIO_PIN_MASK		( 1U << 2U )
+#define LED_PTB3_GPIO_PIN_MASK		( 1U << 3U )
+#define LED_PTB9_GPIO_PIN_MASK		( 1U << 9U )
+#define LED_PTB10_GPIO_PIN_MASK		( 1U << 10U )
+#define LED_PTB11_GPIO_PIN_MASK		( 1U << 11U )
+#define LED_PTB18_GPIO_PIN_MASK		( 1U << 18U )
+#define LED_PTB19_GPIO_PIN_MASK		( 1U << 19U )
+#define LED_PTB20_GPIO_PIN_MASK		( 1U << 20U )
+#define LED_PTB23_GPIO_PIN_MASK		( 1U << 23U )
+
+#endif // PIN_MUX_H
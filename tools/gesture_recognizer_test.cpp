@@ -0,0 +1,191 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Host test of switch gesture recognizer
+//
+// **************************************************************************
+//
+// Build and run on host:
+//
+//   g++ -O2 -Wall -I../tasks/source -o gesture_recognizer_test gesture_recognizer_test.cpp ../tasks/source/gesture_recognizer.cpp
+//   ./gesture_recognizer_test
+//
+// Recorded edges are replayed in ms steps as task_gestures() does: edge is
+// passed at its time, GestureTimeout() is called when GestureNextTimeout()
+// says so. Busy scenarios pass edges late without timeouts between them,
+// as when task did not run. Gestures must match expected ones exactly:
+//
+// - bounces on press and release give one Click,
+// - short glitch does not leave switch pressed,
+// - Click after double click timeout, DoubleClick, early Click,
+// - LongPress, also with late release,
+// - second press after double click deadline is not DoubleClick,
+// - Chord of two switches.
+
+#include <stdio.h>
+#include "gesture_recognizer.h"
+
+// Switches 0 and 1 wait for double click, switch 0 reports Click early
+#define TEST_DOUBLE_MASK		0x03
+#define TEST_EARLY_MASK			0x01
+
+#define TEST_GESTURES_MAX		16
+
+struct TestEdge
+{
+	uint32_t m_time;
+	uint8_t m_switch;
+	bool m_pressed;
+};
+
+static int g_failed = 0;
+
+#define CHECK( cond, ... ) \
+	do { if ( !( cond ) ) { g_failed++; printf( "FAIL %s:%d: ", __FILE__, __LINE__ ); \
+		printf( __VA_ARGS__ ); printf( "\n" ); } } while ( 0 )
+
+static const char *g_type_name[] = { "Click", "DoubleClick", "LongPress", "Chord" };
+
+// Replay edges until t_end, returns number of gestures in t_out
+static int replay( const TestEdge *t_edges, int t_count, uint32_t t_end, bool t_busy, Gesture *t_out )
+{
+	GestureRecognizer l_rec;
+	Gesture l_gestures[ GESTURE_OUT_MAX ];
+	int l_total = 0, l_next = 0;
+
+	GestureInit( &l_rec, TEST_DOUBLE_MASK, TEST_EARLY_MASK );
+
+	for ( uint32_t l_time = 0; l_time <= t_end; l_time++ )
+	{
+		int l_count = 0;
+
+		// busy task gets all edges at time of the last one
+		while ( l_next < t_count && ( t_busy ? t_edges[ t_count - 1 ].m_time : t_edges[ l_next ].m_time ) == l_time )
+		{
+			const TestEdge &l_edge = t_edges[ l_next++ ];
+			l_count = GestureEdge( &l_rec, l_edge.m_switch, l_edge.m_pressed, l_edge.m_time, l_gestures );
+			for ( int i = 0; i < l_count && l_total < TEST_GESTURES_MAX; i++ )
+				t_out[ l_total++ ] = l_gestures[ i ];
+		}
+
+		if ( t_busy && l_next < t_count ) continue;
+
+		if ( GestureNextTimeout( &l_rec, l_time ) == 0 )
+		{
+			l_count = GestureTimeout( &l_rec, l_time, l_gestures );
+			for ( int i = 0; i < l_count && l_total < TEST_GESTURES_MAX; i++ )
+				t_out[ l_total++ ] = l_gestures[ i ];
+		}
+	}
+
+	CHECK( GestureNextTimeout( &l_rec, t_end ) == GESTURE_NO_TIMEOUT, "deadline pending at end" );
+	return l_total;
+}
+
+static void check( const char *t_name, const TestEdge *t_edges, int t_count, bool t_busy,
+		const Gesture *t_expected, int t_expected_count )
+{
+	Gesture l_out[ TEST_GESTURES_MAX ];
+	int l_count = replay( t_edges, t_count, t_edges[ t_count - 1 ].m_time + 2000, t_busy, l_out );
+
+	bool l_ok = l_count == t_expected_count;
+	for ( int i = 0; l_ok && i < l_count; i++ )
+	{
+		const Gesture &l_g = l_out[ i ], &l_e = t_expected[ i ];
+		l_ok = l_g.m_type == l_e.m_type && l_g.m_switch == l_e.m_switch &&
+				l_g.m_mask == l_e.m_mask && l_g.m_time == l_e.m_time;
+	}
+
+	CHECK( l_ok, "%s: %d gestures, expected %d", t_name, l_count, t_expected_count );
+	if ( l_ok ) return;
+	for ( int i = 0; i < l_count; i++ )
+		printf( "  got %s switch %u mask 0x%X at %u ms\n", g_type_name[ ( int ) l_out[ i ].m_type ],
+				l_out[ i ].m_switch, l_out[ i ].m_mask, l_out[ i ].m_time );
+	for ( int i = 0; i < t_expected_count; i++ )
+		printf( "  expected %s switch %u mask 0x%X at %u ms\n", g_type_name[ ( int ) t_expected[ i ].m_type ],
+				t_expected[ i ].m_switch, t_expected[ i ].m_mask, t_expected[ i ].m_time );
+}
+
+#define CHECK_REPLAY( name, busy, edges, ... ) \
+	do { const Gesture l_exp[] = { __VA_ARGS__ }; \
+		check( name, edges, sizeof( edges ) / sizeof( edges[ 0 ] ), busy, l_exp, sizeof( l_exp ) / sizeof( l_exp[ 0 ] ) ); } while ( 0 )
+
+static void test_bounce()
+{
+	const TestEdge l_edges[] = { { 100, 2, true }, { 102, 2, false }, { 104, 2, true },
+			{ 200, 2, false }, { 203, 2, true }, { 206, 2, false } };
+	CHECK_REPLAY( "bounce", false, l_edges, { GestureType::Click, 2, 0x04, 200 } );
+
+	// release within debounce window is accepted when window ends
+	const TestEdge l_glitch[] = { { 100, 2, true }, { 105, 2, false } };
+	CHECK_REPLAY( "glitch", false, l_glitch, { GestureType::Click, 2, 0x04, 120 } );
+}
+
+static void test_click()
+{
+	const TestEdge l_edges[] = { { 100, 2, true }, { 150, 2, false } };
+	CHECK_REPLAY( "click", false, l_edges, { GestureType::Click, 2, 0x04, 150 } );
+
+	// switch waiting for double click reports Click after its deadline
+	const TestEdge l_wait[] = { { 100, 1, true }, { 150, 1, false } };
+	CHECK_REPLAY( "click after wait", false, l_wait, { GestureType::Click, 1, 0x02, 400 } );
+}
+
+static void test_double_click()
+{
+	const TestEdge l_edges[] = { { 100, 1, true }, { 150, 1, false }, { 250, 1, true }, { 300, 1, false } };
+	CHECK_REPLAY( "double click", false, l_edges, { GestureType::DoubleClick, 1, 0x02, 250 } );
+
+	const TestEdge l_early[] = { { 100, 0, true }, { 150, 0, false }, { 250, 0, true }, { 300, 0, false } };
+	CHECK_REPLAY( "early click", false, l_early,
+			{ GestureType::Click, 0, 0x01, 150 }, { GestureType::DoubleClick, 0, 0x01, 250 } );
+}
+
+static void test_long_press()
+{
+	const TestEdge l_edges[] = { { 100, 2, true }, { 1200, 2, false } };
+	CHECK_REPLAY( "long press", false, l_edges, { GestureType::LongPress, 2, 0x04, 900 } );
+
+	// release came after deadline, but before task ran
+	CHECK_REPLAY( "late release", true, l_edges, { GestureType::LongPress, 2, 0x04, 1200 } );
+}
+
+static void test_late_second_press()
+{
+	const TestEdge l_edges[] = { { 100, 1, true }, { 150, 1, false }, { 500, 1, true }, { 550, 1, false } };
+	CHECK_REPLAY( "second press after deadline", false, l_edges,
+			{ GestureType::Click, 1, 0x02, 400 }, { GestureType::Click, 1, 0x02, 800 } );
+
+	// second press came after deadline, but before task ran
+	CHECK_REPLAY( "late second press", true, l_edges,
+			{ GestureType::Click, 1, 0x02, 500 }, { GestureType::Click, 1, 0x02, 800 } );
+}
+
+static void test_chord()
+{
+	const TestEdge l_edges[] = { { 100, 2, true }, { 150, 3, true }, { 300, 2, false }, { 320, 3, false } };
+	CHECK_REPLAY( "chord", false, l_edges, { GestureType::Chord, 2, 0x0C, 150 } );
+}
+
+int main()
+{
+	test_bounce();
+	test_click();
+	test_double_click();
+	test_long_press();
+	test_late_second_press();
+	test_chord();
+
+	if ( g_failed )
+	{
+		printf( "%d checks failed\n", g_failed );
+		return 1;
+	}
+	printf( "All tests passed\n" );
+	return 0;
+}
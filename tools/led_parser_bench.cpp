@@ -0,0 +1,133 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Host benchmark of LED command parsers
+//
+// **************************************************************************
+//
+// Build and run on host:
+//
+//   g++ -O2 -I../tcpip/source -o led_parser_bench led_parser_bench.cpp
+//   ./led_parser_bench [commands] [segment]
+//
+// Compares commands per second of:
+//
+// - single   parse_led_command() on every received block, as former
+//            task_socket_srv, client sends one command per segment,
+// - merged   the same parser on segments with more commands, only first
+//            command of segment is executed,
+// - stream   LedLineParser on segments of given size, commands may be
+//            split between segments.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+#include "led_command.h"
+
+static double now()
+{
+	timespec l_ts;
+	clock_gettime( CLOCK_MONOTONIC, &l_ts );
+	return l_ts.tv_sec + l_ts.tv_nsec * 1e-9;
+}
+
+static void report( const char *t_name, uint32_t t_done, uint32_t t_sent, double t_sec, uint32_t t_check )
+{
+	printf( "%-8s %9u of %9u commands %8.3f ms %12.0f cmd/s (check %u)\n",
+			t_name, t_done, t_sent, t_sec * 1e3, t_done / t_sec, t_check );
+}
+
+int main( int t_narg, char **t_args )
+{
+	uint32_t l_cmds = t_narg > 1 ? atoi( t_args[ 1 ] ) : 1000000;
+	uint32_t l_segment = t_narg > 2 ? atoi( t_args[ 2 ] ) : 256;
+
+	if ( !l_cmds || !l_segment )
+	{
+		fprintf( stderr, "Usage: %s [commands] [segment]\n", t_args[ 0 ] );
+		return 1;
+	}
+
+	// the same commands as socket_cl and msg() send, with zero
+	std::vector< char > l_stream;
+	std::vector< size_t > l_start;
+	for ( uint32_t i = 0; i < l_cmds; i++ )
+	{
+		char l_cmd[ 16 ];
+		int l_len = sprintf( l_cmd, "LED %c %u \n", ( i & 1 ) ? 'R' : 'L', i % 9 );
+		l_start.push_back( l_stream.size() );
+		l_stream.insert( l_stream.end(), l_cmd, l_cmd + l_len + 1 );
+	}
+	l_start.push_back( l_stream.size() );
+
+	Direction_t l_dir;
+	int l_num;
+	uint32_t l_check, l_done;
+	double l_time;
+
+	// one command per segment
+	l_check = l_done = 0;
+	l_time = now();
+	for ( uint32_t i = 0; i < l_cmds; i++ )
+	{
+		char l_buf[ 257 ];
+		size_t l_len = l_start[ i + 1 ] - l_start[ i ];
+		memcpy( l_buf, &l_stream[ l_start[ i ] ], l_len );
+		l_buf[ l_len ] = '\0';
+		if ( parse_led_command( l_buf, &l_dir, &l_num ) )
+		{
+			l_done++;
+			l_check += l_num + l_dir;
+		}
+	}
+	report( "single", l_done, l_cmds, now() - l_time, l_check );
+
+	// more commands per segment, rest of segment is lost
+	l_check = l_done = 0;
+	l_time = now();
+	for ( size_t l_pos = 0; l_pos < l_stream.size(); l_pos += l_segment )
+	{
+		char l_buf[ 257 ];
+		size_t l_len = l_stream.size() - l_pos;
+		if ( l_len > l_segment ) l_len = l_segment;
+		if ( l_len > 256 ) l_len = 256;
+		memcpy( l_buf, &l_stream[ l_pos ], l_len );
+		l_buf[ l_len ] = '\0';
+		if ( parse_led_command( l_buf, &l_dir, &l_num ) )
+		{
+			l_done++;
+			l_check += l_num + l_dir;
+		}
+	}
+	report( "merged", l_done, l_cmds, now() - l_time, l_check );
+
+	// stream parser, commands split between segments
+	LedLineParser l_parser;
+	l_check = l_done = 0;
+	l_time = now();
+	for ( size_t l_pos = 0; l_pos < l_stream.size(); l_pos += l_segment )
+	{
+		size_t l_len = l_stream.size() - l_pos;
+		if ( l_len > l_segment ) l_len = l_segment;
+		l_parser.feed( ( const uint8_t * ) &l_stream[ l_pos ], l_len,
+				[&]( const char *, uint32_t, bool t_ok, Direction_t t_dir, int t_num )
+				{
+					if ( t_ok )
+					{
+						l_done++;
+						l_check += t_num + t_dir;
+					}
+					return true;
+				} );
+	}
+	report( "stream", l_done, l_cmds, now() - l_time, l_check );
+
+	return 0;
+}
@@ -0,0 +1,251 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Host test of RGB LEDs PWM on FTM register mock
+//
+// **************************************************************************
+//
+// Build and run on host:
+//
+//   g++ -O2 -Wall -Iftm_mock -I../tasks/source -o rgb_pwm_test rgb_pwm_test.cpp ../tasks/source/rgb_pwm.cpp
+//   ./rgb_pwm_test
+//
+// tasks/source/rgb_pwm.cpp is built unchanged against headers in ftm_mock.
+// Simulation counts FTM0 from 0 to MOD, loads buffered CnV at the end of
+// period after software trigger, sets flags and calls FTM0_IRQHandler()
+// as hardware would. LED outputs are sampled on GPIOB every count.
+//
+// Tests:
+//
+// - RgbPwmDutyToCnV() for short and full periods,
+// - carrier frequency and state after RgbPwmInit(),
+// - measured duty cycle of every LED pin,
+// - RgbPwmSetDuty() changes nothing without RgbPwmUpdate(),
+// - RgbPwmUpdate() inside period applies new values at its end, not sooner.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "board.h"
+#include "pin_mux.h"
+#include "rgb_pwm.h"
+
+FTM_Type g_mock_ftm0;
+GPIO_Type g_mock_gpiob;
+bool g_mock_irq_enabled;
+uint32_t g_mock_irq_priority;
+
+extern "C" void FTM0_IRQHandler(void);
+
+static const uint32_t g_led_mask[ RGB_PWM_CHANNELS ] =
+{
+		LED_PTB2_GPIO_PIN_MASK | LED_PTB3_GPIO_PIN_MASK | LED_PTB9_GPIO_PIN_MASK,
+		LED_PTB10_GPIO_PIN_MASK | LED_PTB11_GPIO_PIN_MASK | LED_PTB18_GPIO_PIN_MASK,
+		LED_PTB19_GPIO_PIN_MASK | LED_PTB20_GPIO_PIN_MASK | LED_PTB23_GPIO_PIN_MASK,
+};
+
+static int g_failed = 0;
+
+#define CHECK( cond, ... ) \
+	do { if ( !( cond ) ) { g_failed++; printf( "FAIL %s:%d: ", __FILE__, __LINE__ ); \
+		printf( __VA_ARGS__ ); printf( "\n" ); } } while ( 0 )
+
+// One count of FTM0, the same order of events as hardware
+static void ftm_tick()
+{
+	FTM_Type *l_ftm = FTM0;
+
+	if ( l_ftm->CNT >= l_ftm->MOD )
+	{
+		l_ftm->CNT = 0;
+		if ( l_ftm->m_sw_trigger )
+		{
+			for ( int i = 0; i < FTM_CHANNELS; i++ ) l_ftm->m_loaded_cnv[ i ] = l_ftm->CONTROLS[ i ].CnV;
+			l_ftm->m_sw_trigger = false;
+		}
+		l_ftm->m_flags |= kFTM_TimeOverflowFlag;
+	}
+	else
+		l_ftm->CNT++;
+
+	for ( int i = 0; i < RGB_PWM_CHANNELS; i++ )
+		if ( l_ftm->CNT == l_ftm->m_loaded_cnv[ i ] ) l_ftm->m_flags |= 1U << i;
+
+	if ( g_mock_irq_enabled && ( l_ftm->m_flags & l_ftm->m_irq_mask ) )
+		FTM0_IRQHandler();
+}
+
+// Run to the last count of period, next tick starts new period
+static void ftm_run_to_end()
+{
+	do ftm_tick(); while ( FTM0->CNT != FTM0->MOD );
+}
+
+// High counts of LEDs during next t_counts counts, all pins of LED must agree
+static void ftm_measure( uint32_t t_counts, uint32_t *t_high )
+{
+	for ( int l_ch = 0; l_ch < RGB_PWM_CHANNELS; l_ch++ ) t_high[ l_ch ] = 0;
+
+	for ( uint32_t i = 0; i < t_counts; i++ )
+	{
+		ftm_tick();
+		for ( int l_ch = 0; l_ch < RGB_PWM_CHANNELS; l_ch++ )
+		{
+			uint32_t l_pins = GPIOB->PDOR & g_led_mask[ l_ch ];
+			CHECK( !l_pins || l_pins == g_led_mask[ l_ch ], "LED %d pins differ 0x%08X", l_ch, l_pins );
+			t_high[ l_ch ] += l_pins != 0;
+		}
+	}
+}
+
+// Expected high counts of one period for duty
+static uint32_t high_counts( uint32_t t_duty )
+{
+	uint32_t l_period = FTM0->MOD + 1;
+	return RgbPwmDutyToCnV( FTM0->MOD, t_duty ) > FTM0->MOD ? l_period : RgbPwmDutyToCnV( FTM0->MOD, t_duty );
+}
+
+static void check_period( const uint32_t *t_duty, const char *t_what )
+{
+	uint32_t l_high[ RGB_PWM_CHANNELS ];
+	ftm_measure( FTM0->MOD + 1, l_high );
+	for ( int l_ch = 0; l_ch < RGB_PWM_CHANNELS; l_ch++ )
+		CHECK( l_high[ l_ch ] == high_counts( t_duty[ l_ch ] ), "%s: LED %d high %u expected %u",
+				t_what, l_ch, l_high[ l_ch ], high_counts( t_duty[ l_ch ] ) );
+}
+
+static void set_all( const uint32_t *t_duty )
+{
+	for ( int l_ch = 0; l_ch < RGB_PWM_CHANNELS; l_ch++ ) RgbPwmSetDuty( l_ch, t_duty[ l_ch ] );
+	RgbPwmUpdate();
+}
+
+static void test_duty_math()
+{
+	const uint32_t l_mods[] = { 255, 29999, 65535 };
+
+	for ( uint32_t l_mod : l_mods )
+	{
+		CHECK( RgbPwmDutyToCnV( l_mod, 0 ) == 0, "mod %u duty 0", l_mod );
+		CHECK( RgbPwmDutyToCnV( l_mod, RGB_PWM_DUTY_MAX ) == l_mod + 1, "mod %u full duty must not match", l_mod );
+
+		uint32_t l_prev = 0;
+		for ( uint32_t l_duty = 0; l_duty < RGB_PWM_DUTY_MAX; l_duty++ )
+		{
+			uint32_t l_cnv = RgbPwmDutyToCnV( l_mod, l_duty );
+			double l_exact = ( double ) ( l_mod + 1 ) * l_duty / ( 1UL << RGB_PWM_DUTY_BITS );
+			CHECK( l_cnv >= l_prev && l_cnv <= l_mod && l_cnv <= l_exact && l_exact - l_cnv < 1,
+					"mod %u duty %u cnv %u", l_mod, l_duty, l_cnv );
+			l_prev = l_cnv;
+		}
+	}
+}
+
+static void test_init()
+{
+	GPIOB->PDOR = 0xFFFFFFFF;
+	RgbPwmInit();
+
+	uint32_t l_freq = MOCK_BUS_CLOCK_HZ / ( 1U << ( FTM0->SC & 7 ) ) / ( FTM0->MOD + 1 );
+	CHECK( l_freq >= 1000 && l_freq == RGB_PWM_FREQ_HZ, "carrier %u Hz", l_freq );
+	CHECK( FTM0->MOD >= ( 1U << 8 ) - 1, "MOD %u gives less than 8 bits", FTM0->MOD );
+	CHECK( FTM0->m_running && g_mock_irq_enabled, "timer or interrupt not running" );
+	CHECK( ( GPIOB->PDOR & ( g_led_mask[ 0 ] | g_led_mask[ 1 ] | g_led_mask[ 2 ] ) ) == 0, "LEDs not off" );
+	CHECK( GPIOB->PDOR == ~( g_led_mask[ 0 ] | g_led_mask[ 1 ] | g_led_mask[ 2 ] ), "other pins changed" );
+
+	const uint32_t l_off[ RGB_PWM_CHANNELS ] = { 0, 0, 0 };
+	ftm_run_to_end();
+	check_period( l_off, "init" );
+}
+
+static void test_duty()
+{
+	const uint32_t l_duties[][ RGB_PWM_CHANNELS ] =
+	{
+		{ RGB_PWM_DUTY_MAX / 4, RGB_PWM_DUTY_MAX / 2, RGB_PWM_DUTY_MAX },
+		{ 1, RGB_PWM_DUTY_MAX - 1, 0 },
+		{ 0, RGB_PWM_DUTY_MAX, RGB_PWM_DUTY_MAX / 3 },
+	};
+
+	for ( auto &l_duty : l_duties )
+	{
+		set_all( l_duty );
+		ftm_run_to_end();
+		check_period( l_duty, "duty" );
+		check_period( l_duty, "duty again" );
+	}
+}
+
+static void test_buffered()
+{
+	const uint32_t l_old[ RGB_PWM_CHANNELS ] = { RGB_PWM_DUTY_MAX / 2, RGB_PWM_DUTY_MAX / 2, 0 };
+	set_all( l_old );
+	ftm_run_to_end();
+
+	RgbPwmSetDuty( 0, RGB_PWM_DUTY_MAX );
+	RgbPwmSetDuty( 2, RGB_PWM_DUTY_MAX );
+	RgbPwmSetDuty( RGB_PWM_CHANNELS, RGB_PWM_DUTY_MAX );
+	ftm_run_to_end();
+	check_period( l_old, "without update" );
+}
+
+// Old values up to the end of period where RgbPwmUpdate() was called
+static void test_update_in_period()
+{
+	const struct { uint32_t m_old, m_new, m_at; } l_cases[] =
+	{
+		{ RGB_PWM_DUTY_MAX / 4, RGB_PWM_DUTY_MAX / 2, 10 },		// longer after old match
+		{ RGB_PWM_DUTY_MAX / 2, RGB_PWM_DUTY_MAX / 4, 40 },		// shorter before old match
+		{ RGB_PWM_DUTY_MAX / 2, 0, 10 },						// switch off
+		{ RGB_PWM_DUTY_MAX, 0, 50 },							// off after full duty
+		{ 0, RGB_PWM_DUTY_MAX / 2, 10 },						// switch on
+		{ 0, RGB_PWM_DUTY_MAX, 90 },
+	};
+
+	for ( auto &l_case : l_cases )
+	{
+		uint32_t l_old[ RGB_PWM_CHANNELS ], l_new[ RGB_PWM_CHANNELS ], l_high[ RGB_PWM_CHANNELS ];
+		for ( int l_ch = 0; l_ch < RGB_PWM_CHANNELS; l_ch++ )
+		{
+			l_old[ l_ch ] = l_case.m_old;
+			l_new[ l_ch ] = l_case.m_new;
+		}
+		set_all( l_old );
+		ftm_run_to_end();
+
+		// the first part of period, update, the rest
+		uint32_t l_at = ( FTM0->MOD + 1 ) * l_case.m_at / 100;
+		uint32_t l_high_first[ RGB_PWM_CHANNELS ];
+		ftm_measure( l_at, l_high_first );
+		set_all( l_new );
+		ftm_measure( FTM0->MOD + 1 - l_at, l_high );
+
+		for ( int l_ch = 0; l_ch < RGB_PWM_CHANNELS; l_ch++ )
+			CHECK( l_high_first[ l_ch ] + l_high[ l_ch ] == high_counts( l_old[ l_ch ] ),
+					"update %u -> %u at %u%%: period high %u expected %u", l_case.m_old, l_case.m_new,
+					l_case.m_at, l_high_first[ l_ch ] + l_high[ l_ch ], high_counts( l_old[ l_ch ] ) );
+		check_period( l_new, "after update" );
+	}
+}
+
+int main()
+{
+	test_duty_math();
+	test_init();
+	test_duty();
+	test_buffered();
+	test_update_in_period();
+
+	if ( g_failed )
+	{
+		printf( "%d checks failed\n", g_failed );
+		return 1;
+	}
+	printf( "All tests passed, MOD %u, %u Hz, %d bit duty\n", FTM0->MOD,
+			MOCK_BUS_CLOCK_HZ / ( 1U << ( FTM0->SC & 7 ) ) / ( FTM0->MOD + 1 ), RGB_PWM_DUTY_BITS );
+	return 0;
+}
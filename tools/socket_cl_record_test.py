@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+# **************************************************************************
+#
+#               FreeRTOS demo program for OSY labs
+#
+# Subject:      Operating Systems
+# Organization: Department of Computer Science, FEECS,
+#               VSB-Technical University of Ostrava, CZ
+#
+# File:         Host test of button recording in socket_cl
+#
+# **************************************************************************
+#
+# Build and run on host:
+#
+#   g++ -O2 -Wall -o socket_cl ../tcpip/source/socket_cl.cpp
+#   ./socket_cl_record_test.py ./socket_cl
+#
+# Local server plays the board and replays text stream captured from it:
+# button states "BTN xxxx\n" with terminating zero and one echoed command.
+# The stream is sent in segments of every line, at once and split around
+# '\n' and '\0'. For every split socket_cl --record must record 4 states
+# with correct changed bits, print the echo without zero and --dump must
+# read the same 4 states back.
+
+import os
+import socket
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+# captured from board, zero after every button line
+STREAM = ( b"BTN 1000\n\0"
+           b"BTN 0000\n\0"
+           b"LED L 1\n"
+           b"BTN 0100\n\0"
+           b"BTN 0000\n\0" )
+
+# pressed and changed masks, bit 0 is the first button
+STATES = [ ( 0x01, 0x01 ), ( 0x00, 0x01 ), ( 0x02, 0x02 ), ( 0x00, 0x02 ) ]
+
+def segments_lines():
+    l_segs = []
+    l_start = 0
+    for l_pos in range( len( STREAM ) ):
+        if STREAM[ l_pos ] == 0 or ( STREAM[ l_pos ] == 10 and STREAM[ l_pos + 1 ] != 0 ):
+            l_segs.append( STREAM[ l_start : l_pos + 1 ] )
+            l_start = l_pos + 1
+    return l_segs
+
+def segments_split():
+    # every '\0' starts next segment, lines are split in the middle too
+    l_segs = []
+    l_start = 0
+    for l_pos in range( len( STREAM ) ):
+        if STREAM[ l_pos ] == 0 or STREAM[ l_pos ] == ord( '0' ):
+            l_segs.append( STREAM[ l_start : l_pos ] )
+            l_start = l_pos
+    l_segs.append( STREAM[ l_start : ] )
+    return [ s for s in l_segs if s ]
+
+SPLITS = {
+    "lines": segments_lines(),
+    "at once": [ STREAM ],
+    "split": segments_split(),
+}
+
+def serve( t_srv, t_segs ):
+    l_conn, _ = t_srv.accept()
+    l_conn.setsockopt( socket.IPPROTO_TCP, socket.TCP_NODELAY, 1 )
+    for l_seg in t_segs:
+        l_conn.sendall( l_seg )
+        time.sleep( 0.02 )
+    time.sleep( 0.1 )
+    l_conn.close()
+
+def run( t_client, t_name, t_segs, t_dir ):
+    l_errors = []
+    l_rec = os.path.join( t_dir, t_name.replace( " ", "_" ) + ".bin" )
+
+    l_srv = socket.socket()
+    l_srv.bind( ( "127.0.0.1", 0 ) )
+    l_srv.listen( 1 )
+    l_thread = threading.Thread( target = serve, args = ( l_srv, t_segs ) )
+    l_thread.start()
+
+    l_run = subprocess.run( [ t_client, "--record", l_rec, "127.0.0.1", str( l_srv.getsockname()[ 1 ] ) ],
+                            stdin = subprocess.DEVNULL, capture_output = True, timeout = 10 )
+    l_thread.join()
+    l_srv.close()
+
+    if b"Recorded 4 button states" not in l_run.stderr + l_run.stdout:
+        l_errors.append( "client did not record 4 states" )
+    if b"LED L 1\n" not in l_run.stdout or b"\0" in l_run.stdout:
+        l_errors.append( "echo not printed or printed with zero: %r" % l_run.stdout )
+
+    l_dump = subprocess.run( [ t_client, "--dump", l_rec ], capture_output = True, timeout = 10 )
+    l_states = []
+    for l_line in l_dump.stdout.decode().splitlines():
+        if l_line.startswith( "#" ): continue
+        _, l_pressed, l_changed = l_line.split()
+        l_states.append( ( int( l_pressed, 16 ), int( l_changed, 16 ) ) )
+    if l_states != STATES:
+        l_errors.append( "dump %s, expected %s" % ( l_states, STATES ) )
+
+    for l_err in l_errors:
+        print( "FAIL %s: %s" % ( t_name, l_err ) )
+    return len( l_errors )
+
+def main():
+    l_client = sys.argv[ 1 ] if len( sys.argv ) > 1 else "./socket_cl"
+    l_failed = 0
+    with tempfile.TemporaryDirectory() as l_dir:
+        for l_name, l_segs in SPLITS.items():
+            l_failed += run( l_client, l_name, l_segs, l_dir )
+
+    if l_failed:
+        print( "%d checks failed" % l_failed )
+        return 1
+    print( "All tests passed" )
+    return 0
+
+if __name__ == "__main__":
+    sys.exit( main() )
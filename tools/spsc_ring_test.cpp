@@ -0,0 +1,154 @@
+// **************************************************************************
+//
+//               FreeRTOS demo program for OSY labs
+//
+// Subject:      Operating Systems
+// Organization: Department of Computer Science, FEECS,
+//               VSB-Technical University of Ostrava, CZ
+//
+// File:         Host test of lock-free edge ring under bursts
+//
+// **************************************************************************
+//
+// Build and run on host:
+//
+//   g++ -O2 -Wall -pthread -I../sem-int/source -o spsc_ring_test spsc_ring_test.cpp
+//   ./spsc_ring_test [edges]
+//
+// Producer thread plays PORTC ISR: bursts of edges (switch bounce) with
+// pauses between them. Consumer thread plays edge log task and sometimes
+// sleeps longer than burst, so ring overflows. Every edge has sequence
+// number and checksum, test checks that:
+//
+// - consumer gets edges in order, without duplicates and damaged items,
+// - received + dropped == sent, dropped counter matches failed push(),
+// - single thread: full ring refuses every next item, indexes survive
+//   wrap at 2^32.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <chrono>
+#include "spsc_ring.h"
+
+#define TEST_RING_SIZE			16
+#define TEST_BURST_MAX			24
+
+// the same size as EdgeEvent of gpio_interrupts.h and more
+struct TestEdge
+{
+	uint32_t m_seq;
+	uint32_t m_cycles;
+	uint8_t m_pin;
+	bool m_rising;
+	uint32_t m_check;
+};
+
+static uint32_t edge_check( const TestEdge &t_edge )
+{
+	return t_edge.m_seq * 2654435761U ^ t_edge.m_cycles ^ ( t_edge.m_pin << 8 ) ^ t_edge.m_rising;
+}
+
+static int g_failed = 0;
+
+#define CHECK( cond, ... ) \
+	do { if ( !( cond ) ) { g_failed++; printf( "FAIL %s:%d: ", __FILE__, __LINE__ ); \
+		printf( __VA_ARGS__ ); printf( "\n" ); } } while ( 0 )
+
+
+static void test_single_thread()
+{
+	// indexes wrap after a few items
+	SpscRing< uint32_t, 4 > l_ring( UINT32_MAX - 5 );
+	uint32_t l_val;
+
+	CHECK( !l_ring.pop( l_val ), "empty ring pops" );
+	for ( uint32_t i = 0; i < 4; i++ ) CHECK( l_ring.push( i ), "push %u into not full ring", i );
+	CHECK( !l_ring.push( 99 ), "full ring accepts item" );
+	CHECK( l_ring.dropped() == 1 && l_ring.count() == 4, "dropped %u count %u", l_ring.dropped(), l_ring.count() );
+
+	for ( uint32_t i = 0; i < 100; i++ )
+	{
+		CHECK( l_ring.pop( l_val ) && l_val == i, "item %u expected %u", l_val, i );
+		CHECK( l_ring.push( i + 4 ), "push %u after pop", i + 4 );
+		CHECK( !l_ring.push( 99 ), "full ring accepts item" );
+	}
+	CHECK( l_ring.count() == 4 && l_ring.dropped() == 101, "after wrap count %u dropped %u", l_ring.count(), l_ring.dropped() );
+	for ( uint32_t i = 100; i < 104; i++ ) CHECK( l_ring.pop( l_val ) && l_val == i, "item %u expected %u", l_val, i );
+	CHECK( !l_ring.pop( l_val ) && !l_ring.count(), "ring not empty" );
+}
+
+static void test_bursts( uint32_t t_edges )
+{
+	static SpscRing< TestEdge, TEST_RING_SIZE > s_ring;
+	uint32_t l_refused = 0;
+	std::atomic< bool > l_done( false );
+	uint32_t l_received = 0, l_bad = 0, l_order = 0;
+
+	std::thread l_consumer( [&]()
+	{
+		TestEdge l_edge;
+		int64_t l_last = -1;
+		uint32_t l_round = 0;
+
+		while ( 1 )
+		{
+			bool l_finished = l_done.load( std::memory_order_acquire );
+			while ( s_ring.pop( l_edge ) )
+			{
+				l_received++;
+				if ( l_edge.m_check != edge_check( l_edge ) ) l_bad++;
+				if ( ( int64_t ) l_edge.m_seq <= l_last ) l_order++;
+				l_last = l_edge.m_seq;
+			}
+			if ( l_finished ) break;
+
+			// task is sometimes busy with printing
+			if ( ++l_round % 64 == 0 )
+				std::this_thread::sleep_for( std::chrono::microseconds( 200 ) );
+			else
+				std::this_thread::yield();
+		}
+	} );
+
+	srand( 1 );
+	for ( uint32_t l_seq = 0; l_seq < t_edges; )
+	{
+		uint32_t l_burst = 1 + rand() % TEST_BURST_MAX;
+		for ( uint32_t i = 0; i < l_burst && l_seq < t_edges; i++, l_seq++ )
+		{
+			TestEdge l_edge = { l_seq, l_seq * 7, ( uint8_t ) ( 10 + l_seq % 2 ), ( l_seq & 1 ) != 0, 0 };
+			l_edge.m_check = edge_check( l_edge );
+			if ( !s_ring.push( l_edge ) ) l_refused++;
+		}
+		// pause between bursts, consumer mostly catches up
+		std::this_thread::sleep_for( std::chrono::microseconds( rand() % 100 ) );
+	}
+	l_done.store( true, std::memory_order_release );
+	l_consumer.join();
+
+	CHECK( l_bad == 0, "%u damaged edges", l_bad );
+	CHECK( l_order == 0, "%u edges out of order", l_order );
+	CHECK( l_received + s_ring.dropped() == t_edges, "received %u + dropped %u != sent %u",
+			l_received, s_ring.dropped(), t_edges );
+	CHECK( s_ring.dropped() == l_refused, "dropped %u refused %u", s_ring.dropped(), l_refused );
+	CHECK( s_ring.count() == 0, "ring not empty" );
+
+	printf( "Bursts: sent %u received %u dropped %u\n", t_edges, l_received, s_ring.dropped() );
+}
+
+int main( int t_narg, char **t_args )
+{
+	uint32_t l_edges = t_narg > 1 ? atoi( t_args[ 1 ] ) : 200000;
+
+	test_single_thread();
+	test_bursts( l_edges );
+
+	if ( g_failed )
+	{
+		printf( "%d checks failed\n", g_failed );
+		return 1;
+	}
+	printf( "All tests passed\n" );
+	return 0;
+}
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+# **************************************************************************
+#
+#               FreeRTOS demo program for OSY labs
+#
+# Subject:      Operating Systems
+# Organization: Department of Computer Science, FEECS,
+#               VSB-Technical University of Ostrava, CZ
+#
+# File:         Recommended stack sizes from task monitor reports
+#
+# **************************************************************************
+#
+# Usage: stack_report.py [--margin WORDS] [--percent N] [console.log ...]
+#
+# Reads "TM ..." lines printed by task_monitor.cpp (from files or stdin),
+# keeps the lowest high water mark of every task over all reports and
+# prints used and recommended stack depth in words:
+#
+#   recommended = used + max( margin, used * percent / 100 ), rounded up to 8
+#
+# Run the application long enough to exercise all code paths, high water
+# mark only shows the deepest stack usage seen so far.
+
+import argparse
+import fileinput
+import sys
+
+WORD = 4
+
+
+def round_up( t_value, t_to ):
+    return ( t_value + t_to - 1 ) // t_to * t_to
+
+
+def main():
+    l_parser = argparse.ArgumentParser( description = "Recommend stack sizes from task monitor output." )
+    l_parser.add_argument( "--margin", type = int, default = 32, help = "minimal reserve in words (default 32)" )
+    l_parser.add_argument( "--percent", type = int, default = 20, help = "reserve in percent of used stack (default 20)" )
+    l_parser.add_argument( "files", nargs = "*", help = "saved console output, stdin if none" )
+    l_args = l_parser.parse_args()
+
+    l_tasks = {}        # name -> [ depth, lowest high water mark ]
+    l_heap = None       # [ lowest minimum ever free, total ]
+    l_reports = 0
+
+    for l_line in fileinput.input( l_args.files ):
+        l_items = l_line.split()
+        if len( l_items ) < 2 or l_items[ 0 ] != "TM":
+            continue
+        try:
+            if l_items[ 1 ] == "task" and len( l_items ) == 7:
+                l_name, l_depth, l_hwm = l_items[ 2 ], int( l_items[ 5 ] ), int( l_items[ 6 ] )
+                l_old = l_tasks.get( l_name )
+                if l_old is None:
+                    l_tasks[ l_name ] = [ l_depth, l_hwm ]
+                else:
+                    l_old[ 0 ] = max( l_old[ 0 ], l_depth )
+                    l_old[ 1 ] = min( l_old[ 1 ], l_hwm )
+            elif l_items[ 1 ] == "heap" and len( l_items ) == 5:
+                l_min, l_total = int( l_items[ 3 ] ), int( l_items[ 4 ] )
+                l_heap = [ l_min, l_total ] if l_heap is None else [ min( l_heap[ 0 ], l_min ), l_total ]
+            elif l_items[ 1 ] == "end":
+                l_reports += 1
+        except ValueError:
+            # line damaged by output of other task
+            continue
+
+    if not l_tasks:
+        print( "No task monitor report found.", file = sys.stderr )
+        return 1
+
+    print( "Reports: %d" % l_reports )
+    print( "%-20s %8s %8s %8s %12s %10s" % ( "task", "depth", "hwm", "used", "recommended", "saved B" ) )
+
+    l_saved = 0
+    for l_name in sorted( l_tasks ):
+        l_depth, l_hwm = l_tasks[ l_name ]
+        if l_depth == 0:
+            # not created by APP_TASK_CREATE(), only possible reduction is known
+            l_reserve = l_args.margin
+            print( "%-20s %8s %8d %8s %12s %10s" % ( l_name, "?", l_hwm, "?",
+                   "depth-%d" % max( 0, l_hwm - l_reserve ), "?" ) )
+            continue
+
+        l_used = l_depth - l_hwm
+        l_rec = round_up( l_used + max( l_args.margin, l_used * l_args.percent // 100 ), 8 )
+        l_diff = ( l_depth - l_rec ) * WORD
+        l_saved += l_diff
+        print( "%-20s %8d %8d %8d %12d %10d" % ( l_name, l_depth, l_hwm, l_used, l_rec, l_diff ) )
+
+    print( "Total saved: %d bytes" % l_saved )
+    if l_heap:
+        print( "Heap: %d of %d bytes never used" % ( l_heap[ 0 ], l_heap[ 1 ] ) )
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit( main() )
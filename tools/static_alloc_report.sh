@@ -0,0 +1,54 @@
+#!/bin/sh
+# **************************************************************************
+#
+#               FreeRTOS demo program for OSY labs
+#
+# Subject:      Operating Systems
+# Organization: Department of Computer Science, FEECS,
+#               VSB-Technical University of Ostrava, CZ
+#
+# File:         Report of RAM reserved for tasks and kernel objects
+#
+# **************************************************************************
+#
+# Usage: static_alloc_report.sh Debug/tasks.axf
+#
+# Prints static objects created by APP_TASK_CREATE(), APP_QUEUE_CREATE()
+# and APP_SEMAPHORE_CREATE_BINARY() (names s_alloc_*), static objects of
+# FreeRTOS+TCP and size of FreeRTOS heap ucHeap. Application must be built
+# with APP_STATIC_ALLOCATION 1, otherwise only heap is listed.
+#
+# Post-build step of tasks, sem-int and tcpip runs it after
+# arm-none-eabi-size, report is in build console of every build. By hand:
+#
+#   sh ../tools/static_alloc_report.sh Debug/tasks.axf
+
+NM=${NM:-arm-none-eabi-nm}
+
+if [ $# -ne 1 ]; then
+	echo "Usage: $0 <image.axf>" >&2
+	exit 1
+fi
+
+$NM -C -S -t d --size-sort "$1" | awk '
+	{
+		# demangled name of local static may contain spaces
+		name = $0;
+		sub( /^[^ ]+ +[^ ]+ +[^ ]+ +/, "", name );
+		sub( /.*::/, "", name );
+	}
+	name ~ /^s_alloc_|^xIPTask|^xNetworkEvent|^ucNetworkEvent|^xNetworkBufferSemaphoreBuffer|^ucHeap$/ {
+		size = $2 + 0;
+		if ( name ~ /_stack$|Stack$/ ) stack += size;
+		else if ( name ~ /_tcb$|TaskBuffer$/ ) tcb += size;
+		else if ( name == "ucHeap" ) heap += size;
+		else kernel += size;
+		printf( "%8d  %s\n", size, name );
+	}
+	END {
+		printf( "\nStacks:         %8d bytes\n", stack );
+		printf( "TCBs:           %8d bytes\n", tcb );
+		printf( "Queues and sem: %8d bytes\n", kernel );
+		printf( "Static total:   %8d bytes\n", stack + tcb + kernel );
+		printf( "Heap:           %8d bytes\n", heap );
+	}'